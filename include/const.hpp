@@ -22,8 +22,6 @@
 #ifndef STATION_MGMT__CONST__H
 #define STATION_MGMT__CONST__H
 
-#include <Adafruit_BMP280.h>
-
 #define PIN_EPEVER_RO 0    // RX
 #define PIN_EPEVER_RE 3
 #define PIN_EPEVER_DE 2
@@ -44,17 +42,29 @@
 #define NETWORK_SUBNET "172.29.10.0"
 #define NETWORK_UDP_PORT 8888
 #define NETWORK_BUFFER_SIZE 64
+#define NETWORK_BEACON_PORT 8889
+
+#define SENSOR_BMP280_ADDRESS 0x76
 
-// #define RTC_DS3231_ENABLED
+#define SENSOR_INA219_ADDRESS 0x40
+#define SENSOR_INA219_SHUNT 0.1f
 
-#define SENSOR_BMP280_ENABLED
-#define SENSOR_BMP280_ADDRESS BMP280_ADDRESS_ALT
+#ifdef __AVR_ATmega328P__
+    // Uno: the EPEVER bus takes the only UART and the relais move off the Mega header
+    #define MODBUS_SERIAL Serial
+    #define MODBUS_ON_CONSOLE
 
-#define RELAIS_CHANNEL_PINS \
-    { 23, 25, 27, 29, 31, 33, 35, 37 }
+    #define RELAIS_CHANNEL_PINS \
+        { 5, 6, 7, 8, 9, A0, A1, A2 }
+#else
+    #define MODBUS_SERIAL Serial2
+
+    #define RELAIS_CHANNEL_PINS \
+        { 23, 25, 27, 29, 31, 33, 35, 37 }
+#endif
 
 #define RAINBOW_DELAY 75
 
-#define DEBUG
+#include "features.hpp"
 
 #endif
@@ -22,9 +22,27 @@
 #ifndef STATION_MGMT__EEPROM__H
 #define STATION_MGMT__EEPROM__H
 
-#define EEPROM_ADDRESS_CONFIG_VOLTAGE_OFF 0x00
-#define EEPROM_ADDRESS_CONFIG_VOLTAGE_ON 0x04
+#define EEPROM_ADDRESS_CONFIG_LEGACY_VOLTAGE_OFF 0x00
+#define EEPROM_ADDRESS_CONFIG_LEGACY_VOLTAGE_ON 0x04
+#define EEPROM_ADDRESS_CONFIG_LEGACY_FILTER_EMA_ALPHA 0x08
+#define EEPROM_ADDRESS_CONFIG_LEGACY_FILTER_MEDIAN_SIZE 0x0C
+#define EEPROM_ADDRESS_CONFIG_LEGACY_FILTER_HOLD_TIME 0x0D
+#define EEPROM_ADDRESS_CONFIG_LEGACY_BEACON_PERIOD 0x10
+#define EEPROM_ADDRESS_CONFIG_LEGACY_BEACON_ADDRESS 0x12
+
+#define EEPROM_ADDRESS_CONFIG_HEADER 0x40
+#define EEPROM_ADDRESS_CONFIG_DATA 0x48
 
 #define EEPROM_ADDRESS_RELAIS_START 0x80
+#define EEPROM_ADDRESS_SHEDDER 0x88
+
+#define EEPROM_ADDRESS_LOG_LAYOUT 0xF0
+
+#define EEPROM_ADDRESS_LOG_START 0x100
+#ifdef E2END
+    #define EEPROM_ADDRESS_LOG_END (E2END + 1)
+#else
+    #define EEPROM_ADDRESS_LOG_END 0x1000
+#endif
 
 #endif
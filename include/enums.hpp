@@ -57,4 +57,19 @@ enum class Load : uint8_t {
     Overload = 0x03
 };
 
+enum class EventCode : uint8_t {
+    GlobalStatus = 0x01,
+    Relais = 0x02,
+    WrongVoltageIdentification = 0x03,
+    Temperature = 0x04,
+    Battery = 0x05,
+    Charging = 0x06,
+    Arrays = 0x07,
+    Load = 0x08,
+    Reset = 0x09,
+    Modbus = 0x0A,
+    Config = 0x0B,
+    LoadShedding = 0x0C
+};
+
 #endif
@@ -0,0 +1,90 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__FEATURES__H
+#define STATION_MGMT__FEATURES__H
+
+// Components compiled into the firmware, one set per site profile. platformio.ini selects the profile of each env
+// through SITE_PROFILE_*, the full station is built when none is given. A disabled component takes its driver,
+// its globals, its loop tasks and its debug strings out of the image, and its opcodes are answered with a NACK.
+
+#if defined(SITE_PROFILE_LEAN)
+    // Uno controlling the relais from the charge controller alone
+    #define RELAIS_ENABLED
+
+#elif defined(SITE_PROFILE_RELAY)
+    // Mega switching the repeater loads, without meteo sensor nor card
+    #define RELAIS_ENABLED
+    #define STATISTICS_ENABLED
+    #define DIAGNOSTICS_ENABLED
+    #define EPEVER_DETAILS_ENABLED
+
+#else
+    // Full station, also built when no profile is given
+
+    // #define RTC_DS3231_ENABLED
+
+    // Host builds (tools/replay) take their sensor readings from the trace being replayed
+    #ifdef HOST_BUILD
+        #define SENSORS_REPLAYED
+    #else
+        #define SENSOR_BMP280_ENABLED
+    #endif
+
+    // #define SENSOR_INA219_ENABLED
+
+    #define SD_LOGGER_ENABLED
+    #define RELAIS_ENABLED
+    #define STATISTICS_ENABLED
+    #define DIAGNOSTICS_ENABLED
+
+    // Load output, temperatures, state of charge and energy counters of the charge controller
+    #define EPEVER_DETAILS_ENABLED
+
+    // Records inbound traffic for tools/replay, on the serial port or on the SD logger card
+    // #define TRACE_ENABLED
+    // #define TRACE_TO_SD
+#endif
+
+// The bus driver is only linked in when a device sits on it
+#if defined(RTC_DS3231_ENABLED) || defined(SENSOR_BMP280_ENABLED) || defined(SENSOR_INA219_ENABLED)
+    #define I2C_ENABLED
+#endif
+
+// The sensor registry and SENSORS_READ come with the first sensor, METEO with the BMP280 that feeds it
+#if defined(SENSOR_BMP280_ENABLED) || defined(SENSOR_INA219_ENABLED) || defined(SENSORS_REPLAYED)
+    #define SENSORS_ENABLED
+#endif
+
+#if defined(SENSOR_BMP280_ENABLED) || defined(SENSORS_REPLAYED)
+    #define METEO_ENABLED
+#endif
+
+#if defined(TRACE_ENABLED) && !defined(TRACE_TO_SD) && defined(MODBUS_ON_CONSOLE)
+    #error "A serial trace needs the console port, which this board gives to the EPEVER bus"
+#endif
+
+// Benchmark builds measure the release code path, and a serial trace needs the port for itself
+#if !defined(BENCHMARK_ENABLED) && !defined(MODBUS_ON_CONSOLE) && (!defined(TRACE_ENABLED) || defined(TRACE_TO_SD))
+    #define DEBUG
+#endif
+
+#endif
@@ -22,6 +22,14 @@
 #ifndef STATION_MGMT__PROTOCOL__H
 #define STATION_MGMT__PROTOCOL__H
 
+// tools/client/client.hpp decodes every response on the host side, keep it in step when a layout changes.
+
+// Optional request header: '#', version, 16 bit big-endian sequence chosen by the client.
+// When present it is echoed in front of the response (or NACK), carrying the firmware protocol version.
+#define PROTOCOL_HEADER '#'
+#define PROTOCOL_HEADER_SIZE 4
+#define PROTOCOL_VERSION 0x01
+
 #define PROTOCOL_PING 'p'
 #define PROTOCOL_RESET 'X'
 #define PROTOCOL_TELEMETRY 't'
@@ -31,9 +39,33 @@
 #define PROTOCOL_RTC_SET 'R'
 #define PROTOCOL_CONFIG_READ 'c'
 #define PROTOCOL_CONFIG_SET 'C'
+#define PROTOCOL_CONFIG_READ_ALL 'g'
+#define PROTOCOL_CONFIG_SET_ALL 'G'
 #define PROTOCOL_OUTPUT_READ 'o'
 #define PROTOCOL_OUTPUT_SET 'O'
+#define PROTOCOL_STATS_READ 'a'
+#define PROTOCOL_STATS_RESET 'A'
+#define PROTOCOL_DIAGNOSTICS 'd'
+#define PROTOCOL_BEACON 'b'
+#define PROTOCOL_EVENT 'E'
+#define PROTOCOL_EVENT_SUBSCRIBE 'e'
+#define PROTOCOL_EVENT_UNSUBSCRIBE 'u'
+#define PROTOCOL_EVENT_ACK 'k'
+#define PROTOCOL_LOG_READ 'l'
+#define PROTOCOL_SD_READ 'f'
+#define PROTOCOL_SENSORS_READ 'y'
+#define PROTOCOL_LOADS_READ 'w'
+#define PROTOCOL_LOADS_SET 'W'
+#define PROTOCOL_TIME_SYNC 'T'
+#define PROTOCOL_CONTROLLER_READ 'x'
+#define PROTOCOL_ENERGY_READ 'h'
 
 #define PROTOCOL_NACK 'N'
 
+// Timestamps are 64 bit station times, see timebase.hpp
+#define PROTOCOL_TELEMETRY_SIZE 29
+#define PROTOCOL_STATUS_SIZE 6
+#define PROTOCOL_METEO_SIZE 16
+#define PROTOCOL_TIME_SYNC_REQUEST_SIZE 16
+
 #endif
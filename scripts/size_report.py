@@ -0,0 +1,106 @@
+# Station MGMT
+#
+# Copyright (C) 2023:
+#  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+#  - Stefano Lande IS0EIR (landeste@gmail.com)
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+# PlatformIO post-build script: prints .text/.data/.bss usage of the firmware
+# ELF and the largest stack frames collected through -fstack-usage.
+
+import os
+import subprocess
+
+Import("env")
+
+RAM_SIZE = int(env.BoardConfig().get("upload.maximum_ram_size", 0))
+FLASH_SIZE = int(env.BoardConfig().get("upload.maximum_size", 0))
+STACK_REPORT_ENTRIES = 10
+
+
+def read_sections(elf_path):
+    size_tool = env.subst("$SIZETOOL") or "avr-size"
+    output = subprocess.check_output([size_tool, "-A", elf_path]).decode()
+
+    sections = {}
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) >= 2 and fields[0].startswith(".") and fields[1].isdigit():
+            sections[fields[0]] = int(fields[1])
+    return sections
+
+
+def read_stack_usage(build_dir):
+    frames = []
+    for root, _, files in os.walk(build_dir):
+        for name in files:
+            if not name.endswith(".su"):
+                continue
+            with open(os.path.join(root, name)) as su_file:
+                for line in su_file:
+                    fields = line.rstrip().split("\t")
+                    if len(fields) != 3:
+                        continue
+                    location, size, qualifier = fields
+                    frames.append((int(size), qualifier, location))
+    frames.sort(reverse=True)
+    return frames
+
+
+def site_profile():
+    for define in env.get("CPPDEFINES", []):
+        name = str(define[0] if isinstance(define, (list, tuple)) else define)
+        if name.startswith("SITE_PROFILE_"):
+            return name[len("SITE_PROFILE_"):].lower()
+    return "full"
+
+
+def percentage(value, total):
+    if total == 0:
+        return ""
+    return " (%.1f%%)" % (100.0 * value / total)
+
+
+def size_report(source, target, env):
+    elf_path = str(target[0])
+    sections = read_sections(elf_path)
+
+    text = sections.get(".text", 0)
+    data = sections.get(".data", 0)
+    bss = sections.get(".bss", 0)
+    noinit = sections.get(".noinit", 0)
+    static_ram = data + bss + noinit
+
+    print("")
+    print("Size report for %s, env %s, site profile %s" % (
+        os.path.basename(elf_path), env.subst("$PIOENV"), site_profile()))
+    print("  .text   %6d bytes" % text)
+    print("  .data   %6d bytes" % data)
+    print("  .bss    %6d bytes" % bss)
+    print("  .noinit %6d bytes" % noinit)
+    print("  flash   %6d bytes%s" % (text + data, percentage(text + data, FLASH_SIZE)))
+    print("  ram     %6d bytes%s, %d bytes left for stack and heap" % (
+        static_ram, percentage(static_ram, RAM_SIZE), RAM_SIZE - static_ram))
+
+    frames = read_stack_usage(env.subst("$BUILD_DIR"))
+    if not frames:
+        print("  no stack usage data found (-fstack-usage)")
+        return
+
+    print("  largest stack frames:")
+    for size, qualifier, location in frames[:STACK_REPORT_ENTRIES]:
+        print("    %5d bytes %-16s %s" % (size, qualifier, location))
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", size_report)
@@ -0,0 +1,69 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__BENCHMARK__H
+#define STATION_MGMT__BENCHMARK__H
+
+// Section markers read by the simavr harness in tools/simavr, which includes this header too:
+// keep it plain C and append new sections at the end so existing ids stay stable.
+#define BENCHMARK_SECTIONS(X) \
+    X(Loop, 0x01) \
+    X(ReceiveCommand, 0x02) \
+    X(AcquireSensors, 0x03) \
+    X(ReadEpeverData, 0x04) \
+    X(ReadEpeverStatus, 0x05) \
+    X(ScanMemory, 0x06) \
+    X(SendBeacon, 0x07) \
+    X(SendEvents, 0x08) \
+    X(FlushEventLog, 0x09) \
+    X(FlushSdLog, 0x0A) \
+    X(ReadRTC, 0x0B) \
+    X(Evaluation, 0x0C) \
+    X(SwapEndianness, 0x0D) \
+    X(FilterPush, 0x0E) \
+    X(StatisticsPush, 0x0F) \
+    X(FlushTrace, 0x10) \
+    X(LoadShedding, 0x11) \
+    X(ReadEpeverEnergy, 0x12) \
+    X(ReadEpeverDetails, 0x13)
+
+#define BENCHMARK_ENUM(name, id) BENCHMARK_##name = id,
+
+enum BenchmarkSection { BENCHMARK_SECTIONS(BENCHMARK_ENUM) };
+
+// Data space addresses of GPIOR0/1/2 on the ATmega2560
+#define BENCHMARK_REGISTER_COMMAND 0x3E
+#define BENCHMARK_REGISTER_BEGIN 0x4A
+#define BENCHMARK_REGISTER_END 0x4B
+
+#if defined(BENCHMARK_ENABLED) && defined(__AVR__)
+    #include <avr/io.h>
+
+    #define benchmarkBegin(name) GPIOR1 = BENCHMARK_##name
+    #define benchmarkEnd(name) GPIOR2 = BENCHMARK_##name
+    #define benchmarkCommand(opcode) GPIOR0 = opcode
+#else
+    #define benchmarkBegin(name)
+    #define benchmarkEnd(name)
+    #define benchmarkCommand(opcode)
+#endif
+
+#endif
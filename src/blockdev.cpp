@@ -0,0 +1,168 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "blockdev.hpp"
+
+#include <stdio.h>
+
+#include "const.hpp"
+
+#ifdef SD_LOGGER_ENABLED
+void getBlockDeviceFilename(char* dest, const uint16_t file) {
+    snprintf(dest, BLOCK_DEVICE_FILENAME_SIZE, "D%05u.BIN", file);
+}
+
+    #ifdef ARDUINO
+SdBlockDevice::SdBlockDevice() {
+    ready = false;
+    currentFile = 0;
+    unflushed = 0;
+}
+
+SdBlockDevice::~SdBlockDevice() = default;
+
+bool SdBlockDevice::begin(const uint8_t chipSelect) {
+    ready = SD.begin(chipSelect);
+    return ready;
+}
+
+bool SdBlockDevice::appendBlock(const uint16_t file, const uint8_t* block) {
+    if (!ready)
+        return false;
+
+    if (!current || currentFile != file) {
+        if (current)
+            current.close();
+
+        char filename[BLOCK_DEVICE_FILENAME_SIZE];
+        getBlockDeviceFilename(filename, file);
+        current = SD.open(filename, FILE_WRITE);
+        currentFile = file;
+        unflushed = 0;
+        if (!current)
+            return false;
+    }
+
+    const size_t written = current.write(block, BLOCK_DEVICE_BLOCK_SIZE);
+
+    // Flushing rewrites the directory entry and the FAT, far slower than the block itself
+    if (++unflushed >= BLOCK_DEVICE_FLUSH_BLOCKS) {
+        current.flush();
+        unflushed = 0;
+    }
+
+    return written == BLOCK_DEVICE_BLOCK_SIZE;
+}
+
+int SdBlockDevice::readFile(const uint16_t file, const uint32_t offset, uint8_t* dest, const uint16_t size) {
+    if (!ready)
+        return -1;
+
+    // A reader only sees what the directory entry says is there
+    if (current && currentFile == file && unflushed > 0) {
+        current.flush();
+        unflushed = 0;
+    }
+
+    char filename[BLOCK_DEVICE_FILENAME_SIZE];
+    getBlockDeviceFilename(filename, file);
+    File reader = SD.open(filename, FILE_READ);
+    if (!reader)
+        return -1;
+
+    int result = 0;
+    if (reader.seek(offset))
+        result = reader.read(dest, size);
+
+    reader.close();
+    return result;
+}
+    #else
+        #include <limits.h>
+
+FileBlockDevice::FileBlockDevice() {
+    root = ".";
+    current = nullptr;
+    currentFile = 0;
+    unflushed = 0;
+}
+
+FileBlockDevice::~FileBlockDevice() {
+    if (current != nullptr)
+        fclose(current);
+}
+
+bool FileBlockDevice::begin(const char* directory) {
+    root = directory;
+    return true;
+}
+
+bool FileBlockDevice::appendBlock(const uint16_t file, const uint8_t* block) {
+    if (current == nullptr || currentFile != file) {
+        if (current != nullptr)
+            fclose(current);
+
+        char path[PATH_MAX];
+        getPath(path, file);
+        current = fopen(path, "ab");
+        currentFile = file;
+        unflushed = 0;
+        if (current == nullptr)
+            return false;
+    }
+
+    const size_t written = fwrite(block, 1, BLOCK_DEVICE_BLOCK_SIZE, current);
+
+    if (++unflushed >= BLOCK_DEVICE_FLUSH_BLOCKS) {
+        fflush(current);
+        unflushed = 0;
+    }
+
+    return written == BLOCK_DEVICE_BLOCK_SIZE;
+}
+
+int FileBlockDevice::readFile(const uint16_t file, const uint32_t offset, uint8_t* dest, const uint16_t size) {
+    if (current != nullptr && currentFile == file && unflushed > 0) {
+        fflush(current);
+        unflushed = 0;
+    }
+
+    char path[PATH_MAX];
+    getPath(path, file);
+    FILE* reader = fopen(path, "rb");
+    if (reader == nullptr)
+        return -1;
+
+    int result = 0;
+    if (fseek(reader, offset, SEEK_SET) == 0)
+        result = static_cast<int>(fread(dest, 1, size, reader));
+
+    fclose(reader);
+    return result;
+}
+
+void FileBlockDevice::getPath(char* dest, const uint16_t file) const {
+    char filename[BLOCK_DEVICE_FILENAME_SIZE];
+    getBlockDeviceFilename(filename, file);
+    snprintf(dest, PATH_MAX, "%s/%s", root, filename);
+}
+    #endif
+#endif
@@ -0,0 +1,93 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__BLOCKDEV__H
+#define STATION_MGMT__BLOCKDEV__H
+
+#include <stdint.h>
+
+#include "const.hpp"
+
+#define BLOCK_DEVICE_BLOCK_SIZE 512
+#define BLOCK_DEVICE_FILENAME_SIZE 11
+// Blocks appended between two flushes of the file size and allocation table, the most a power cut can lose
+#define BLOCK_DEVICE_FLUSH_BLOCKS 8
+
+#if defined(ARDUINO) && defined(SD_LOGGER_ENABLED)
+    #include <SD.h>
+
+class SdBlockDevice {
+    public:
+
+        SdBlockDevice();
+
+        ~SdBlockDevice();
+
+        bool begin(uint8_t chipSelect);
+
+        bool appendBlock(uint16_t file, const uint8_t* block);
+
+        int readFile(uint16_t file, uint32_t offset, uint8_t* dest, uint16_t size);
+
+    private:
+
+        bool ready;
+        File current;
+        uint16_t currentFile;
+        uint8_t unflushed;
+};
+
+using BlockDevice = SdBlockDevice;
+#elif defined(ARDUINO)
+// Without a card only null devices are passed around, and the SD library stays out of the build
+class BlockDevice;
+#else
+    #include <stdio.h>
+
+class FileBlockDevice {
+    public:
+
+        FileBlockDevice();
+
+        ~FileBlockDevice();
+
+        bool begin(const char* directory);
+
+        bool appendBlock(uint16_t file, const uint8_t* block);
+
+        int readFile(uint16_t file, uint32_t offset, uint8_t* dest, uint16_t size);
+
+    private:
+
+        const char* root;
+        FILE* current;
+        uint16_t currentFile;
+        uint8_t unflushed;
+
+        void getPath(char* dest, uint16_t file) const;
+};
+
+using BlockDevice = FileBlockDevice;
+#endif
+
+void getBlockDeviceFilename(char* dest, uint16_t file);
+
+#endif
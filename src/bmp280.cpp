@@ -0,0 +1,246 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "bmp280.hpp"
+
+#include <string.h>
+
+#include "const.hpp"
+
+#ifdef SENSOR_BMP280_ENABLED
+Bmp280::Bmp280(const uint8_t address) {
+    this->address = address;
+    state = State::Identify;
+    sensorId = 0;
+    errors = 0;
+    converted = false;
+
+    memset(&transaction, 0, sizeof(I2cTransaction));
+    transaction.result = I2cResult::Idle;
+
+    digT1 = 0;
+    digT2 = 0;
+    digT3 = 0;
+    digP1 = 0;
+    digP2 = 0;
+    digP3 = 0;
+    digP4 = 0;
+    digP5 = 0;
+    digP6 = 0;
+    digP7 = 0;
+    digP8 = 0;
+    digP9 = 0;
+
+    temperature = 0;
+    pressure = 0;
+}
+
+Bmp280::~Bmp280() = default;
+
+void Bmp280::update() {
+    if (transaction.result == I2cResult::Pending)
+        return;
+
+    switch (state) {
+        case State::Identify:
+            txBuffer[0] = BMP280_REGISTER_CHIP_ID;
+            request(1, 1);
+            break;
+
+        case State::Calibrate:
+            txBuffer[0] = BMP280_REGISTER_CALIBRATION;
+            request(1, BMP280_CALIBRATION_SIZE);
+            break;
+
+        case State::Configure:
+            // Register/value pairs, config first while the sensor still sleeps
+            txBuffer[0] = BMP280_REGISTER_CONFIG;
+            txBuffer[1] = BMP280_CONFIG_VALUE;
+            txBuffer[2] = BMP280_REGISTER_CONTROL;
+            txBuffer[3] = BMP280_CONTROL_VALUE;
+            request(4, 0);
+            break;
+
+        case State::Ready:
+            txBuffer[0] = BMP280_REGISTER_PRESSURE;
+            request(1, BMP280_MEASUREMENT_SIZE);
+            break;
+    }
+}
+
+void Bmp280::init() {
+    update();
+}
+
+bool Bmp280::startConversion() {
+    if (transaction.result == I2cResult::Pending)
+        return false;
+
+    // The sensor converts continuously in normal mode, a conversion is a burst read of the latest result
+    const bool ready = state == State::Ready;
+    converted = false;
+    update();
+    return ready;
+}
+
+bool Bmp280::isReady() {
+    // The bus settles the result before it runs the callback, the values are there only once compensate() is done
+    return converted;
+}
+
+uint8_t Bmp280::read(float* values) {
+    if (transaction.result != I2cResult::Success)
+        return 0;
+
+    values[0] = temperature;
+    values[1] = pressure / 100.0f;
+    return BMP280_CHANNELS;
+}
+
+SensorType Bmp280::getType() const {
+    return SensorType::Bmp280;
+}
+
+uint8_t Bmp280::getChannelCount() const {
+    return BMP280_CHANNELS;
+}
+
+SensorQuantity Bmp280::getQuantity(const uint8_t channel) const {
+    return channel == 0 ? SensorQuantity::Temperature : SensorQuantity::Pressure;
+}
+
+uint8_t Bmp280::getSensorId() const {
+    return sensorId;
+}
+
+uint16_t Bmp280::getErrors() const {
+    return errors;
+}
+
+void Bmp280::request(const uint8_t txSize, const uint8_t rxSize) {
+    transaction.address = address;
+    transaction.txData = txBuffer;
+    transaction.txSize = txSize;
+    transaction.rxData = rxBuffer;
+    transaction.rxSize = rxSize;
+    transaction.timeout = 0;
+    transaction.callback = onComplete;
+    transaction.context = this;
+
+    if (!I2cBus::getInstance()->submit(&transaction))
+        errors++;
+}
+
+void Bmp280::onComplete(I2cTransaction& transaction) {
+    auto* sensor = static_cast<Bmp280*>(transaction.context);
+
+    // Any failure restarts from identification, the sensor may have been power cycled
+    if (transaction.result != I2cResult::Success) {
+        sensor->errors++;
+        sensor->state = State::Identify;
+        sensor->converted = true;
+        return;
+    }
+
+    switch (sensor->state) {
+        case State::Identify:
+            sensor->sensorId = sensor->rxBuffer[0];
+            if (sensor->sensorId == BMP280_CHIP_ID) {
+                sensor->state = State::Calibrate;
+                sensor->update();
+            } else {
+                sensor->errors++;
+            }
+            break;
+
+        case State::Calibrate:
+            sensor->parseCalibration();
+            sensor->state = State::Configure;
+            sensor->update();
+            break;
+
+        case State::Configure:
+            sensor->state = State::Ready;
+            break;
+
+        case State::Ready:
+            sensor->compensate();
+            sensor->converted = true;
+            break;
+    }
+}
+
+void Bmp280::parseCalibration() {
+    const auto word = [this](const uint8_t index) {
+        return static_cast<uint16_t>(rxBuffer[index] | (rxBuffer[index + 1] << 8));
+    };
+
+    digT1 = word(0);
+    digT2 = static_cast<int16_t>(word(2));
+    digT3 = static_cast<int16_t>(word(4));
+    digP1 = word(6);
+    digP2 = static_cast<int16_t>(word(8));
+    digP3 = static_cast<int16_t>(word(10));
+    digP4 = static_cast<int16_t>(word(12));
+    digP5 = static_cast<int16_t>(word(14));
+    digP6 = static_cast<int16_t>(word(16));
+    digP7 = static_cast<int16_t>(word(18));
+    digP8 = static_cast<int16_t>(word(20));
+    digP9 = static_cast<int16_t>(word(22));
+}
+
+void Bmp280::compensate() {
+    const int32_t adcP = (static_cast<int32_t>(rxBuffer[0]) << 12)
+                         | (static_cast<int32_t>(rxBuffer[1]) << 4)
+                         | (rxBuffer[2] >> 4);
+    const int32_t adcT = (static_cast<int32_t>(rxBuffer[3]) << 12)
+                         | (static_cast<int32_t>(rxBuffer[4]) << 4)
+                         | (rxBuffer[5] >> 4);
+
+    // Integer compensation from the BMP280 datasheet, section 8.2
+    int32_t var1 = ((((adcT >> 3) - (static_cast<int32_t>(digT1) << 1))) * static_cast<int32_t>(digT2)) >> 11;
+    int32_t var2 = (((((adcT >> 4) - static_cast<int32_t>(digT1)) * ((adcT >> 4) - static_cast<int32_t>(digT1))) >> 12)
+                    * static_cast<int32_t>(digT3))
+                   >> 14;
+    const int32_t tFine = var1 + var2;
+
+    temperature = static_cast<float>((tFine * 5 + 128) >> 8) / 100.0f;
+
+    int64_t pVar1 = static_cast<int64_t>(tFine) - 128000;
+    int64_t pVar2 = pVar1 * pVar1 * static_cast<int64_t>(digP6);
+    pVar2 = pVar2 + ((pVar1 * static_cast<int64_t>(digP5)) << 17);
+    pVar2 = pVar2 + (static_cast<int64_t>(digP4) << 35);
+    pVar1 = ((pVar1 * pVar1 * static_cast<int64_t>(digP3)) >> 8) + ((pVar1 * static_cast<int64_t>(digP2)) << 12);
+    pVar1 = (((static_cast<int64_t>(1) << 47) + pVar1) * static_cast<int64_t>(digP1)) >> 33;
+
+    if (pVar1 == 0)
+        return;
+
+    int64_t p = 1048576 - adcP;
+    p = (((p << 31) - pVar2) * 3125) / pVar1;
+    pVar1 = (static_cast<int64_t>(digP9) * (p >> 13) * (p >> 13)) >> 25;
+    pVar2 = (static_cast<int64_t>(digP8) * p) >> 19;
+    p = ((p + pVar1 + pVar2) >> 8) + (static_cast<int64_t>(digP7) << 4);
+
+    // Q24.8 Pa
+    pressure = static_cast<float>(p) / 256.0f;
+}
+#endif
@@ -0,0 +1,125 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__BMP280__H
+#define STATION_MGMT__BMP280__H
+
+#include <stdint.h>
+
+#include "i2c.hpp"
+#include "sensors.hpp"
+
+#define BMP280_ADDRESS 0x77
+#define BMP280_ADDRESS_ALT 0x76
+#define BMP280_CHIP_ID 0x58
+
+#define BMP280_REGISTER_CALIBRATION 0x88
+#define BMP280_REGISTER_CHIP_ID 0xD0
+#define BMP280_REGISTER_CONTROL 0xF4
+#define BMP280_REGISTER_CONFIG 0xF5
+#define BMP280_REGISTER_PRESSURE 0xF7
+
+#define BMP280_CALIBRATION_SIZE 24
+#define BMP280_MEASUREMENT_SIZE 6
+#define BMP280_CHANNELS 2
+
+// Normal mode, temperature x2, pressure x16
+#define BMP280_CONTROL_VALUE 0x57
+// 500 ms standby, IIR filter x16
+#define BMP280_CONFIG_VALUE 0x90
+
+class Bmp280 : public SensorDriver {
+    public:
+
+        explicit Bmp280(uint8_t address);
+
+        ~Bmp280() override;
+
+        void init() override;
+
+        bool startConversion() override;
+
+        bool isReady() override;
+
+        uint8_t read(float* values) override;
+
+        [[nodiscard]]
+        SensorType getType() const override;
+
+        [[nodiscard]]
+        uint8_t getChannelCount() const override;
+
+        [[nodiscard]]
+        SensorQuantity getQuantity(uint8_t channel) const override;
+
+        [[nodiscard]]
+        uint8_t getSensorId() const;
+
+        [[nodiscard]]
+        uint16_t getErrors() const;
+
+    private:
+
+        enum class State : uint8_t {
+            Identify,
+            Calibrate,
+            Configure,
+            Ready
+        };
+
+        uint8_t address;
+        State state;
+        uint8_t sensorId;
+        uint16_t errors;
+        bool converted;
+
+        I2cTransaction transaction;
+        uint8_t txBuffer[4];
+        uint8_t rxBuffer[BMP280_CALIBRATION_SIZE];
+
+        uint16_t digT1;
+        int16_t digT2;
+        int16_t digT3;
+        uint16_t digP1;
+        int16_t digP2;
+        int16_t digP3;
+        int16_t digP4;
+        int16_t digP5;
+        int16_t digP6;
+        int16_t digP7;
+        int16_t digP8;
+        int16_t digP9;
+
+        float temperature;
+        float pressure;
+
+        void update();
+
+        void request(uint8_t txSize, uint8_t rxSize);
+
+        void parseCalibration();
+
+        void compensate();
+
+        static void onComplete(I2cTransaction& transaction);
+};
+
+#endif
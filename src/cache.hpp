@@ -0,0 +1,66 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__CACHE__H
+#define STATION_MGMT__CACHE__H
+
+#include <stddef.h>
+
+template <size_t N>
+class ResponseCache {
+    public:
+
+        ResponseCache() {
+            valid = false;
+        }
+
+        ~ResponseCache() = default;
+
+        void invalidate() {
+            valid = false;
+        }
+
+        [[nodiscard]]
+        bool isValid() const {
+            return valid;
+        }
+
+        [[nodiscard]]
+        char* getBuffer() {
+            return data;
+        }
+
+        void validate() {
+            valid = true;
+        }
+
+        template <typename W>
+        size_t writeTo(W& writer) const {
+            return writer.writeBytes(data, N);
+        }
+
+    private:
+
+        char data[N];
+        bool valid;
+};
+
+#endif
@@ -21,49 +21,384 @@
 
 #include "config.hpp"
 
+#include <Arduino.h>
 #include <EEPROM.h>
+#include <math.h>
+#include <string.h>
 
 #include "eeprom.hpp"
+#include "filter.hpp"
+#include "utils.hpp"
+
+constexpr ParamDescriptor CONFIG_PARAMS[] PROGMEM = {
+    {CONFIG_MAIN_VOLTAGE_OFF_PARAM,   ParamType::Float,   0,  0.0f,  100.0f,                 11.5f},
+    {CONFIG_MAIN_VOLTAGE_ON_PARAM,    ParamType::Float,   4,  0.0f,  100.0f,                 12.5f},
+    {CONFIG_FILTER_EMA_ALPHA_PARAM,   ParamType::Float,   8,  0.01f, 1.0f,                   1.0f },
+    {CONFIG_FILTER_MEDIAN_SIZE_PARAM, ParamType::Uint8,   12, 1.0f,  FILTER_MEDIAN_MAX_SIZE, 1.0f },
+    {CONFIG_FILTER_HOLD_TIME_PARAM,   ParamType::Uint16,  13, 0.0f,  600.0f,                 0.0f },
+    {CONFIG_BEACON_PERIOD_PARAM,      ParamType::Uint16,  15, 0.0f,  3600.0f,                0.0f },
+    {CONFIG_BEACON_ADDRESS_PARAM,     ParamType::Address, 17, 0.0f,  0.0f,                   0.0f },
+    {CONFIG_LOAD_MIN_ON_TIME_PARAM,   ParamType::Uint16,  21, 0.0f,  3600.0f,                60.0f},
+    {CONFIG_LOAD_MIN_OFF_TIME_PARAM,  ParamType::Uint16,  23, 0.0f,  3600.0f,                300.0f},
+};
+
+static_assert(
+    sizeof(CONFIG_PARAMS) / sizeof(ParamDescriptor) == static_cast<size_t>(Param::Count),
+    "CONFIG_PARAMS must describe every Param");
+
+// Version 1 layout, one fixed EEPROM address per parameter and no header
+constexpr uint8_t CONFIG_LEGACY_ADDRESSES[] PROGMEM = {
+    EEPROM_ADDRESS_CONFIG_LEGACY_VOLTAGE_OFF,
+    EEPROM_ADDRESS_CONFIG_LEGACY_VOLTAGE_ON,
+    EEPROM_ADDRESS_CONFIG_LEGACY_FILTER_EMA_ALPHA,
+    EEPROM_ADDRESS_CONFIG_LEGACY_FILTER_MEDIAN_SIZE,
+    EEPROM_ADDRESS_CONFIG_LEGACY_FILTER_HOLD_TIME,
+    EEPROM_ADDRESS_CONFIG_LEGACY_BEACON_PERIOD,
+    EEPROM_ADDRESS_CONFIG_LEGACY_BEACON_ADDRESS,
+};
+
+struct ConfigHeader {
+        uint16_t magic;
+        uint8_t version;
+        uint8_t size;
+        uint16_t layoutCrc;
+        uint16_t dataCrc;
+};
+
+static_assert(sizeof(ConfigHeader) == CONFIG_HEADER_SIZE, "ConfigHeader size mismatch");
 
 Config::Config() {
-    mainVoltageOff = readFromEEPROM(EEPROM_ADDRESS_CONFIG_VOLTAGE_OFF);
-    mainVoltageOn = readFromEEPROM(EEPROM_ADDRESS_CONFIG_VOLTAGE_ON);
+    ConfigHeader header;
+    auto* headerPointer = reinterpret_cast<uint8_t*>(&header);
+    for (uint8_t i = 0; i < CONFIG_HEADER_SIZE; i++)
+        headerPointer[i] = EEPROM.read(EEPROM_ADDRESS_CONFIG_HEADER + i);
+    for (uint8_t i = 0; i < CONFIG_DATA_SIZE; i++)
+        data[i] = EEPROM.read(EEPROM_ADDRESS_CONFIG_DATA + i);
+
+    const uint8_t version = header.magic == CONFIG_MAGIC ? header.version : 1;
+
+    if (version == CONFIG_LAYOUT_VERSION && header.size == CONFIG_DATA_SIZE && header.layoutCrc == getLayoutCrc()
+        && header.dataCrc == crc16(data, CONFIG_DATA_SIZE)) {
+        sanitize();
+        return;
+    }
+
+    switch (version) {
+        case 1:
+            migrateFromLegacy();
+            break;
+
+        case 2:
+            migrateFromVersion2();
+            break;
+
+        default:
+            loadDefaults();
+            break;
+    }
+
+    sanitize();
+    commit();
 }
 
 Config::~Config() = default;
 
 float Config::getMainVoltageOff() const {
-    return mainVoltageOff;
+    return getValue<float>(Param::MainVoltageOff);
 }
 
-void Config::setMainVoltageOff(const float newValue) {
-    mainVoltageOff = newValue;
-    writeToEEPROM(EEPROM_ADDRESS_CONFIG_VOLTAGE_OFF, mainVoltageOff);
+float Config::getMainVoltageOn() const {
+    return getValue<float>(Param::MainVoltageOn);
 }
 
-float Config::getMainVoltageOn() const {
-    return mainVoltageOn;
+float Config::getFilterEmaAlpha() const {
+    return getValue<float>(Param::FilterEmaAlpha);
+}
+
+uint8_t Config::getFilterMedianSize() const {
+    return getValue<uint8_t>(Param::FilterMedianSize);
+}
+
+uint16_t Config::getFilterHoldTime() const {
+    return getValue<uint16_t>(Param::FilterHoldTime);
+}
+
+uint16_t Config::getBeaconPeriod() const {
+    return getValue<uint16_t>(Param::BeaconPeriod);
+}
+
+uint32_t Config::getBeaconAddress() const {
+    return getValue<uint32_t>(Param::BeaconAddress);
+}
+
+uint16_t Config::getLoadMinOnTime() const {
+    return getValue<uint16_t>(Param::LoadMinOnTime);
+}
+
+uint16_t Config::getLoadMinOffTime() const {
+    return getValue<uint16_t>(Param::LoadMinOffTime);
+}
+
+uint8_t Config::indexOf(const char id) {
+    for (uint8_t i = 0; i < static_cast<uint8_t>(Param::Count); i++)
+        if (static_cast<char>(pgm_read_byte(&CONFIG_PARAMS[i].id)) == id)
+            return i;
+
+    return CONFIG_PARAM_UNKNOWN;
+}
+
+uint8_t Config::getValueSize(const uint8_t index) {
+    switch (static_cast<ParamType>(pgm_read_byte(&CONFIG_PARAMS[index].type))) {
+        case ParamType::Float:
+            return sizeof(float);
+
+        case ParamType::Uint8:
+            return sizeof(uint8_t);
+
+        case ParamType::Uint16:
+            return sizeof(uint16_t);
+
+        case ParamType::Address:
+            return sizeof(uint32_t);
+
+        default:
+            return 0;
+    }
+}
+
+char Config::getId(const uint8_t index) {
+    return static_cast<char>(pgm_read_byte(&CONFIG_PARAMS[index].id));
 }
 
-void Config::setMainVoltageOn(float newValue) {
-    mainVoltageOn = newValue;
-    writeToEEPROM(EEPROM_ADDRESS_CONFIG_VOLTAGE_ON, mainVoltageOn);
+ParamType Config::getType(const uint8_t index) {
+    return static_cast<ParamType>(pgm_read_byte(&CONFIG_PARAMS[index].type));
 }
 
-float Config::readFromEEPROM(const int address) {
+size_t Config::serialize(const uint8_t index, char* dest) const {
+    ParamDescriptor descriptor;
+    readDescriptor(index, descriptor);
+
+    switch (descriptor.type) {
+        case ParamType::Float:
+            {
+                float value;
+                memcpy(&value, data + descriptor.offset, sizeof(float));
+                return packValue(dest, value);
+            }
+
+        case ParamType::Uint8:
+            return packValue(dest, data[descriptor.offset]);
+
+        case ParamType::Uint16:
+            {
+                uint16_t value;
+                memcpy(&value, data + descriptor.offset, sizeof(uint16_t));
+                return packValue(dest, value);
+            }
+
+        case ParamType::Address:
+            // Kept in network byte order, as IPAddress stores it
+            memcpy(dest, data + descriptor.offset, sizeof(uint32_t));
+            return sizeof(uint32_t);
+
+        default:
+            return 0;
+    }
+}
+
+bool Config::deserialize(const uint8_t index, const char* src) {
+    ParamDescriptor descriptor;
+    readDescriptor(index, descriptor);
+
     float value;
-    auto* valuePointer = reinterpret_cast<uint8_t*>(&value);
-    valuePointer[0] = EEPROM.read(address + 0);
-    valuePointer[1] = EEPROM.read(address + 1);
-    valuePointer[2] = EEPROM.read(address + 2);
-    valuePointer[3] = EEPROM.read(address + 3);
+    switch (descriptor.type) {
+        case ParamType::Float:
+            memcpy(&value, src, sizeof(float));
+            swapEndianness(&value, sizeof(float));
+            break;
+
+        case ParamType::Uint8:
+            value = static_cast<uint8_t>(src[0]);
+            break;
+
+        case ParamType::Uint16:
+            {
+                uint16_t tempValue;
+                memcpy(&tempValue, src, sizeof(uint16_t));
+                swapEndianness(&tempValue, sizeof(uint16_t));
+                value = tempValue;
+            }
+            break;
+
+        case ParamType::Address:
+            memcpy(data + descriptor.offset, src, sizeof(uint32_t));
+            return true;
+
+        default:
+            return false;
+    }
+
+    if (isnan(value) || value < descriptor.minValue || value > descriptor.maxValue)
+        return false;
+
+    setNumericValue(descriptor, value);
+    return true;
+}
+
+uint8_t Config::deserializeAll(const char* src, const size_t size) {
+    uint8_t applied = 0;
+
+    size_t position = 0;
+    while (position < size) {
+        const uint8_t index = indexOf(src[position]);
+        if (index == CONFIG_PARAM_UNKNOWN)
+            break;
+
+        const uint8_t valueSize = getValueSize(index);
+        if (position + 1 + valueSize > size)
+            break;
+
+        if (deserialize(index, src + position + 1))
+            applied++;
+
+        position += 1 + valueSize;
+    }
+
+    return applied;
+}
+
+void Config::commit() {
+    for (uint8_t i = 0; i < CONFIG_DATA_SIZE; i++)
+        EEPROM.update(EEPROM_ADDRESS_CONFIG_DATA + i, data[i]);
+
+    ConfigHeader header;
+    header.magic = CONFIG_MAGIC;
+    header.version = CONFIG_LAYOUT_VERSION;
+    header.size = CONFIG_DATA_SIZE;
+    header.layoutCrc = getLayoutCrc();
+    header.dataCrc = crc16(data, CONFIG_DATA_SIZE);
+
+    const auto* headerPointer = reinterpret_cast<const uint8_t*>(&header);
+    for (uint8_t i = 0; i < CONFIG_HEADER_SIZE; i++)
+        EEPROM.update(EEPROM_ADDRESS_CONFIG_HEADER + i, headerPointer[i]);
+}
+
+template <typename T>
+T Config::getValue(const Param param) const {
+    T value;
+    memcpy(&value, data + pgm_read_byte(&CONFIG_PARAMS[static_cast<uint8_t>(param)].offset), sizeof(T));
     return value;
 }
 
-void Config::writeToEEPROM(const int address, const float& value) {
-    auto* valuePointer = reinterpret_cast<const uint8_t*>(&value);
-    EEPROM.write(address + 0, valuePointer[0]);
-    EEPROM.write(address + 1, valuePointer[1]);
-    EEPROM.write(address + 2, valuePointer[2]);
-    EEPROM.write(address + 3, valuePointer[3]);
+float Config::getNumericValue(const ParamDescriptor& descriptor) const {
+    switch (descriptor.type) {
+        case ParamType::Float:
+            {
+                float value;
+                memcpy(&value, data + descriptor.offset, sizeof(float));
+                return value;
+            }
+
+        case ParamType::Uint8:
+            return data[descriptor.offset];
+
+        case ParamType::Uint16:
+            {
+                uint16_t value;
+                memcpy(&value, data + descriptor.offset, sizeof(uint16_t));
+                return value;
+            }
+
+        default:
+            return 0;
+    }
+}
+
+void Config::setNumericValue(const ParamDescriptor& descriptor, const float value) {
+    switch (descriptor.type) {
+        case ParamType::Float:
+            memcpy(data + descriptor.offset, &value, sizeof(float));
+            break;
+
+        case ParamType::Uint8:
+            data[descriptor.offset] = static_cast<uint8_t>(lroundf(value));
+            break;
+
+        case ParamType::Uint16:
+            {
+                const auto tempValue = static_cast<uint16_t>(lroundf(value));
+                memcpy(data + descriptor.offset, &tempValue, sizeof(uint16_t));
+            }
+            break;
+
+        case ParamType::Address:
+            {
+                const auto tempValue = static_cast<uint32_t>(value);
+                memcpy(data + descriptor.offset, &tempValue, sizeof(uint32_t));
+            }
+            break;
+    }
+}
+
+void Config::loadDefaults() {
+    ParamDescriptor descriptor;
+    for (uint8_t i = 0; i < static_cast<uint8_t>(Param::Count); i++) {
+        readDescriptor(i, descriptor);
+        setNumericValue(descriptor, descriptor.defaultValue);
+    }
+}
+
+void Config::sanitize() {
+    ParamDescriptor descriptor;
+    for (uint8_t i = 0; i < static_cast<uint8_t>(Param::Count); i++) {
+        readDescriptor(i, descriptor);
+        if (descriptor.type == ParamType::Address)
+            continue;
+
+        const float value = getNumericValue(descriptor);
+        if (isnan(value) || value < descriptor.minValue || value > descriptor.maxValue)
+            setNumericValue(descriptor, descriptor.defaultValue);
+    }
+}
+
+void Config::migrateFromLegacy() {
+    ParamDescriptor descriptor;
+    for (uint8_t i = 0; i < sizeof(CONFIG_LEGACY_ADDRESSES); i++) {
+        readDescriptor(i, descriptor);
+        const uint8_t address = pgm_read_byte(&CONFIG_LEGACY_ADDRESSES[i]);
+        const uint8_t size = getValueSize(i);
+        for (uint8_t j = 0; j < size; j++)
+            data[descriptor.offset + j] = EEPROM.read(address + j);
+    }
+
+    // Parameters the legacy layout never had are the ones version 3 appended
+    migrateFromVersion2();
+}
+
+void Config::migrateFromVersion2() {
+    // Version 3 only appended parameters, the version 2 data already sits at the same offsets
+    ParamDescriptor descriptor;
+    for (uint8_t i = 0; i < static_cast<uint8_t>(Param::Count); i++) {
+        readDescriptor(i, descriptor);
+        if (descriptor.offset >= CONFIG_DATA_SIZE_V2)
+            setNumericValue(descriptor, descriptor.defaultValue);
+    }
+}
+
+void Config::readDescriptor(const uint8_t index, ParamDescriptor& descriptor) {
+    memcpy_P(&descriptor, &CONFIG_PARAMS[index], sizeof(ParamDescriptor));
+}
+
+uint16_t Config::getLayoutCrc() {
+    uint16_t crc = crc16(nullptr, 0);
+
+    ParamDescriptor descriptor;
+    for (uint8_t i = 0; i < static_cast<uint8_t>(Param::Count); i++) {
+        readDescriptor(i, descriptor);
+        crc = crc16(reinterpret_cast<const uint8_t*>(&descriptor.id), sizeof(descriptor.id), crc);
+        crc = crc16(reinterpret_cast<const uint8_t*>(&descriptor.type), sizeof(descriptor.type), crc);
+        crc = crc16(&descriptor.offset, sizeof(descriptor.offset), crc);
+    }
+
+    return crc;
 }
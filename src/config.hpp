@@ -22,10 +22,56 @@
 #ifndef STATION_MGMT__CONFIG__H
 #define STATION_MGMT__CONFIG__H
 
+#include <stddef.h>
 #include <stdint.h>
 
 #define CONFIG_MAIN_VOLTAGE_OFF_PARAM 'o'
 #define CONFIG_MAIN_VOLTAGE_ON_PARAM 'O'
+#define CONFIG_FILTER_EMA_ALPHA_PARAM 'a'
+#define CONFIG_FILTER_MEDIAN_SIZE_PARAM 'm'
+#define CONFIG_FILTER_HOLD_TIME_PARAM 'h'
+#define CONFIG_BEACON_PERIOD_PARAM 'b'
+#define CONFIG_BEACON_ADDRESS_PARAM 'B'
+#define CONFIG_LOAD_MIN_ON_TIME_PARAM 'l'
+#define CONFIG_LOAD_MIN_OFF_TIME_PARAM 'L'
+
+#define CONFIG_MAGIC 0x4346
+#define CONFIG_LAYOUT_VERSION 3
+#define CONFIG_HEADER_SIZE 8
+#define CONFIG_DATA_SIZE 25
+#define CONFIG_DATA_SIZE_V2 21
+
+#define CONFIG_PARAM_UNKNOWN 0xFF
+#define CONFIG_VALUE_MAX_SIZE 4
+
+enum class ParamType : uint8_t {
+    Float = 0x01,
+    Uint8 = 0x02,
+    Uint16 = 0x03,
+    Address = 0x04
+};
+
+enum class Param : uint8_t {
+    MainVoltageOff,
+    MainVoltageOn,
+    FilterEmaAlpha,
+    FilterMedianSize,
+    FilterHoldTime,
+    BeaconPeriod,
+    BeaconAddress,
+    LoadMinOnTime,
+    LoadMinOffTime,
+    Count
+};
+
+struct ParamDescriptor {
+        char id;
+        ParamType type;
+        uint8_t offset;
+        float minValue;
+        float maxValue;
+        float defaultValue;
+};
 
 class Config {
     public:
@@ -37,21 +83,88 @@ class Config {
         [[nodiscard]]
         float getMainVoltageOff() const;
 
-        void setMainVoltageOff(float newValue);
-
         [[nodiscard]]
         float getMainVoltageOn() const;
 
-        void setMainVoltageOn(float newValue);
+        [[nodiscard]]
+        float getFilterEmaAlpha() const;
+
+        [[nodiscard]]
+        uint8_t getFilterMedianSize() const;
+
+        [[nodiscard]]
+        uint16_t getFilterHoldTime() const;
+
+        [[nodiscard]]
+        uint16_t getBeaconPeriod() const;
+
+        [[nodiscard]]
+        uint32_t getBeaconAddress() const;
+
+        [[nodiscard]]
+        uint16_t getLoadMinOnTime() const;
+
+        [[nodiscard]]
+        uint16_t getLoadMinOffTime() const;
+
+        static uint8_t indexOf(char id);
+
+        static uint8_t getValueSize(uint8_t index);
+
+        static char getId(uint8_t index);
+
+        static ParamType getType(uint8_t index);
+
+        size_t serialize(uint8_t index, char* dest) const;
+
+        bool deserialize(uint8_t index, const char* src);
+
+        template <typename W>
+        size_t serializeAll(W& writer) const;
+
+        uint8_t deserializeAll(const char* src, size_t size);
+
+        void commit();
 
     private:
 
-        float mainVoltageOff;
-        float mainVoltageOn;
+        uint8_t data[CONFIG_DATA_SIZE];
 
-        static float readFromEEPROM(int address);
+        template <typename T>
+        T getValue(Param param) const;
+
+        [[nodiscard]]
+        float getNumericValue(const ParamDescriptor& descriptor) const;
 
-        static void writeToEEPROM(int address, const float& value);
+        void setNumericValue(const ParamDescriptor& descriptor, float value);
+
+        void loadDefaults();
+
+        void sanitize();
+
+        void migrateFromLegacy();
+
+        void migrateFromVersion2();
+
+        static void readDescriptor(uint8_t index, ParamDescriptor& descriptor);
+
+        static uint16_t getLayoutCrc();
 };
 
+template <typename W>
+size_t Config::serializeAll(W& writer) const {
+    char value[CONFIG_VALUE_MAX_SIZE];
+
+    size_t size = 0;
+    size += writer.writeValue(static_cast<uint8_t>(Param::Count));
+
+    for (uint8_t i = 0; i < static_cast<uint8_t>(Param::Count); i++) {
+        size += writer.writeValue(getId(i));
+        size += writer.writeValue(getType(i));
+        size += writer.writeBytes(value, serialize(i, value));
+    }
+
+    return size;
+}
+
 #endif
@@ -0,0 +1,129 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "diagnostics.hpp"
+
+#ifdef __AVR__
+    #include <avr/io.h>
+    #include <stddef.h>
+
+struct __freelist {
+    size_t sz;
+    __freelist* nx;
+};
+
+extern uint8_t _end;
+extern uint8_t __stack;
+extern char __heap_start;
+extern char* __brkval;
+extern size_t __malloc_margin;
+extern __freelist* __flp;
+
+uint8_t resetCause __attribute__((section(".noinit")));
+
+// Runs before .data/.bss initialization, while the stack is still empty
+void paintStack() __attribute__((naked, used, section(".init3")));
+
+void paintStack() {
+    resetCause = MCUSR;
+    MCUSR = 0;
+
+    for (uint8_t* p = &_end; p <= &__stack; p++)
+        *p = DIAGNOSTICS_STACK_CANARY;
+}
+#endif
+
+Diagnostics::Diagnostics() {
+    stackHighWaterMark = 0;
+    stackUnused = 0;
+    heapFree = 0;
+    heapLargestFreeBlock = 0;
+}
+
+Diagnostics::~Diagnostics() = default;
+
+void Diagnostics::scan() {
+#ifdef __AVR__
+    auto* heapEnd = reinterpret_cast<uint8_t*>(__brkval == nullptr ? &__heap_start : __brkval);
+
+    const uint8_t* p = heapEnd;
+    while (p <= &__stack && *p == DIAGNOSTICS_STACK_CANARY)
+        p++;
+
+    stackUnused = p - heapEnd;
+    stackHighWaterMark = &__stack - p + 1;
+
+    const auto stackPointer = reinterpret_cast<uint8_t*>(SP);
+    size_t gap = stackPointer > heapEnd ? stackPointer - heapEnd : 0;
+    gap = gap > __malloc_margin ? gap - __malloc_margin : 0;
+
+    size_t freeTotal = gap;
+    size_t freeLargest = gap;
+    for (const __freelist* block = __flp; block != nullptr; block = block->nx) {
+        freeTotal += block->sz;
+        if (block->sz > freeLargest)
+            freeLargest = block->sz;
+    }
+
+    heapFree = freeTotal;
+    heapLargestFreeBlock = freeLargest;
+#endif
+}
+
+uint8_t Diagnostics::getResetCause() const {
+#ifdef __AVR__
+    return resetCause;
+#else
+    return 0;
+#endif
+}
+
+uint16_t Diagnostics::getRamSize() const {
+#ifdef __AVR__
+    return RAMEND - RAMSTART + 1;
+#else
+    return 0;
+#endif
+}
+
+uint16_t Diagnostics::getStaticRam() const {
+#ifdef __AVR__
+    return reinterpret_cast<uint16_t>(&_end) - RAMSTART;
+#else
+    return 0;
+#endif
+}
+
+uint16_t Diagnostics::getStackHighWaterMark() const {
+    return stackHighWaterMark;
+}
+
+uint16_t Diagnostics::getStackUnused() const {
+    return stackUnused;
+}
+
+uint16_t Diagnostics::getHeapFree() const {
+    return heapFree;
+}
+
+uint16_t Diagnostics::getHeapLargestFreeBlock() const {
+    return heapLargestFreeBlock;
+}
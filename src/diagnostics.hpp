@@ -0,0 +1,73 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__DIAGNOSTICS__H
+#define STATION_MGMT__DIAGNOSTICS__H
+
+#include <stdint.h>
+
+#define DIAGNOSTICS_STACK_CANARY 0xC5
+
+#define DIAGNOSTICS_RESET_POWER_ON 0x01
+#define DIAGNOSTICS_RESET_EXTERNAL 0x02
+#define DIAGNOSTICS_RESET_BROWN_OUT 0x04
+#define DIAGNOSTICS_RESET_WATCHDOG 0x08
+#define DIAGNOSTICS_RESET_JTAG 0x10
+
+class Diagnostics {
+    public:
+
+        Diagnostics();
+
+        ~Diagnostics();
+
+        void scan();
+
+        [[nodiscard]]
+        uint8_t getResetCause() const;
+
+        [[nodiscard]]
+        uint16_t getRamSize() const;
+
+        [[nodiscard]]
+        uint16_t getStaticRam() const;
+
+        [[nodiscard]]
+        uint16_t getStackHighWaterMark() const;
+
+        [[nodiscard]]
+        uint16_t getStackUnused() const;
+
+        [[nodiscard]]
+        uint16_t getHeapFree() const;
+
+        [[nodiscard]]
+        uint16_t getHeapLargestFreeBlock() const;
+
+    private:
+
+        uint16_t stackHighWaterMark;
+        uint16_t stackUnused;
+        uint16_t heapFree;
+        uint16_t heapLargestFreeBlock;
+};
+
+#endif
@@ -0,0 +1,191 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ds3231.hpp"
+
+#include <Arduino.h>
+#include <string.h>
+
+#include "const.hpp"
+
+#ifdef RTC_DS3231_ENABLED
+// Days between 1970-01-01 and 2000-01-01, the DS3231 only counts years 00-99
+    #define DS3231_EPOCH_DAYS 10957UL
+    #define DS3231_SECONDS_PER_DAY 86400UL
+
+static uint16_t daysFromCivil(const uint8_t year, const uint8_t month, const uint8_t day) {
+    constexpr uint16_t daysBeforeMonth[] = {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+
+    uint16_t days = year * 365 + (year + 3) / 4 + daysBeforeMonth[month - 1] + day - 1;
+    if (month > 2 && year % 4 == 0)
+        days++;
+    return days;
+}
+
+Ds3231::Ds3231() {
+    valid = false;
+    unixtime = 0;
+    readAt = 0;
+    errors = 0;
+
+    memset(&transaction, 0, sizeof(I2cTransaction));
+    transaction.result = I2cResult::Idle;
+}
+
+Ds3231::~Ds3231() = default;
+
+void Ds3231::update() {
+    if (transaction.result == I2cResult::Pending)
+        return;
+
+    txBuffer[0] = DS3231_REGISTER_SECONDS;
+
+    transaction.address = DS3231_ADDRESS;
+    transaction.txData = txBuffer;
+    transaction.txSize = 1;
+    transaction.rxData = rxBuffer;
+    transaction.rxSize = DS3231_TIME_SIZE;
+    transaction.timeout = 0;
+    transaction.callback = onComplete;
+    transaction.context = this;
+
+    if (!I2cBus::getInstance()->submit(&transaction))
+        errors++;
+}
+
+bool Ds3231::setUnixtime(const uint32_t newUnixtime) {
+    if (transaction.result == I2cResult::Pending)
+        return false;
+
+    uint32_t days = newUnixtime / DS3231_SECONDS_PER_DAY;
+    const uint32_t seconds = newUnixtime % DS3231_SECONDS_PER_DAY;
+    if (days < DS3231_EPOCH_DAYS)
+        return false;
+    days -= DS3231_EPOCH_DAYS;
+
+    uint8_t year = 0;
+    while (days >= (year % 4 == 0 ? 366U : 365U)) {
+        days -= year % 4 == 0 ? 366 : 365;
+        year++;
+    }
+
+    uint8_t month = 1;
+    while (month < 12) {
+        const uint16_t monthDays = daysFromCivil(year, month + 1, 1) - daysFromCivil(year, month, 1);
+        if (days < monthDays)
+            break;
+        days -= monthDays;
+        month++;
+    }
+
+    // 1970-01-01 was a Thursday, the DS3231 counts the weekday 1-7 from Monday
+    const auto weekday = static_cast<uint8_t>((newUnixtime / DS3231_SECONDS_PER_DAY + 3) % 7 + 1);
+
+    txBuffer[0] = DS3231_REGISTER_SECONDS;
+    txBuffer[1] = toBcd(seconds % 60);
+    txBuffer[2] = toBcd(seconds / 60 % 60);
+    txBuffer[3] = toBcd(seconds / 3600);
+    txBuffer[4] = weekday;
+    txBuffer[5] = toBcd(days + 1);
+    txBuffer[6] = toBcd(month);
+    txBuffer[7] = toBcd(year);
+
+    transaction.address = DS3231_ADDRESS;
+    transaction.txData = txBuffer;
+    transaction.txSize = DS3231_TIME_SIZE + 1;
+    transaction.rxData = rxBuffer;
+    transaction.rxSize = 0;
+    transaction.timeout = 0;
+    transaction.callback = onComplete;
+    transaction.context = this;
+
+    if (!I2cBus::getInstance()->submit(&transaction)) {
+        errors++;
+        return false;
+    }
+
+    unixtime = newUnixtime;
+    readAt = millis();
+    valid = true;
+    return true;
+}
+
+bool Ds3231::isValid() const {
+    return valid;
+}
+
+uint32_t Ds3231::getUnixtime() const {
+    // Extrapolated from the last read, so callers never wait on the bus
+    return unixtime + (millis() - readAt) / 1000UL;
+}
+
+uint16_t Ds3231::getErrors() const {
+    return errors;
+}
+
+void Ds3231::parseTime() {
+    const uint8_t second = fromBcd(rxBuffer[0] & 0x7F);
+    const uint8_t minute = fromBcd(rxBuffer[1] & 0x7F);
+
+    uint8_t hour;
+    if (rxBuffer[2] & 0x40) {
+        hour = fromBcd(rxBuffer[2] & 0x1F) % 12;
+        if (rxBuffer[2] & 0x20)
+            hour += 12;
+    } else {
+        hour = fromBcd(rxBuffer[2] & 0x3F);
+    }
+
+    const uint8_t day = fromBcd(rxBuffer[4] & 0x3F);
+    const uint8_t month = fromBcd(rxBuffer[5] & 0x1F);
+    const uint8_t year = fromBcd(rxBuffer[6]);
+
+    if (month < 1 || month > 12 || day < 1) {
+        errors++;
+        return;
+    }
+
+    const uint32_t days = DS3231_EPOCH_DAYS + daysFromCivil(year, month, day);
+    unixtime = days * DS3231_SECONDS_PER_DAY + hour * 3600UL + minute * 60UL + second;
+    readAt = millis();
+    valid = true;
+}
+
+void Ds3231::onComplete(I2cTransaction& transaction) {
+    auto* clock = static_cast<Ds3231*>(transaction.context);
+
+    if (transaction.result != I2cResult::Success) {
+        clock->errors++;
+        return;
+    }
+
+    if (transaction.rxSize > 0)
+        clock->parseTime();
+}
+
+uint8_t Ds3231::fromBcd(const uint8_t value) {
+    return (value >> 4) * 10 + (value & 0x0F);
+}
+
+uint8_t Ds3231::toBcd(const uint8_t value) {
+    return ((value / 10) << 4) | (value % 10);
+}
+#endif
@@ -0,0 +1,73 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__DS3231__H
+#define STATION_MGMT__DS3231__H
+
+#include <stdint.h>
+
+#include "i2c.hpp"
+
+#define DS3231_ADDRESS 0x68
+#define DS3231_REGISTER_SECONDS 0x00
+#define DS3231_TIME_SIZE 7
+
+class Ds3231 {
+    public:
+
+        Ds3231();
+
+        ~Ds3231();
+
+        void update();
+
+        bool setUnixtime(uint32_t unixtime);
+
+        [[nodiscard]]
+        bool isValid() const;
+
+        [[nodiscard]]
+        uint32_t getUnixtime() const;
+
+        [[nodiscard]]
+        uint16_t getErrors() const;
+
+    private:
+
+        bool valid;
+        uint32_t unixtime;
+        unsigned long readAt;
+        uint16_t errors;
+
+        I2cTransaction transaction;
+        uint8_t txBuffer[DS3231_TIME_SIZE + 1];
+        uint8_t rxBuffer[DS3231_TIME_SIZE];
+
+        void parseTime();
+
+        static void onComplete(I2cTransaction& transaction);
+
+        static uint8_t fromBcd(uint8_t value);
+
+        static uint8_t toBcd(uint8_t value);
+};
+
+#endif
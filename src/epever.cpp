@@ -0,0 +1,140 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "epever.hpp"
+
+#include <string.h>
+
+#include "events.hpp"
+
+#define EPEVER_BLOCK_ADDRESS(name, address, count) address,
+#define EPEVER_BLOCK_COUNT(name, address, count) count,
+
+static const uint16_t BLOCK_ADDRESSES[] = {EPEVER_BLOCKS(EPEVER_BLOCK_ADDRESS)};
+static const uint8_t BLOCK_COUNTS[] = {EPEVER_BLOCKS(EPEVER_BLOCK_COUNT)};
+
+Epever::Epever(ModbusMaster& node) : node(node) {
+    for (uint8_t& result : results)
+        result = ModbusMaster::ku8MBSuccess;
+
+#ifdef EPEVER_DETAILS_ENABLED
+    memset(&details, 0, sizeof(EpeverDetails));
+#endif
+}
+
+Epever::~Epever() = default;
+
+uint8_t Epever::read(const EpeverBlock block) {
+    const auto index = static_cast<uint8_t>(block);
+    const uint8_t result = node.readInputRegisters(BLOCK_ADDRESSES[index], BLOCK_COUNTS[index]);
+
+    if (result != results[index]) {
+        results[index] = result;
+        Events::getInstance()->publish(EventCode::Modbus, index, result);
+    }
+
+#ifdef EPEVER_DETAILS_ENABLED
+    if (result == ModbusMaster::ku8MBSuccess)
+        decode(block);
+#endif
+
+    return result;
+}
+
+uint8_t Epever::getResult(const EpeverBlock block) const {
+    return results[static_cast<uint8_t>(block)];
+}
+
+uint16_t Epever::getAddress(const EpeverBlock block) {
+    return BLOCK_ADDRESSES[static_cast<uint8_t>(block)];
+}
+
+uint8_t Epever::getCount(const EpeverBlock block) {
+    return BLOCK_COUNTS[static_cast<uint8_t>(block)];
+}
+
+#ifdef EPEVER_DETAILS_ENABLED
+const EpeverDetails& Epever::getDetails() const {
+    return details;
+}
+
+void Epever::decode(const EpeverBlock block) {
+    switch (block) {
+        case EpeverBlock::RealTime:
+            details.realTimeAt = TimeBase::getInstance()->getUptime();
+            details.panelPower = getLongValue(0x02, 100.0f);
+            details.batteryChargePower = getLongValue(0x06, 100.0f);
+            details.loadVoltage = getValue(0x0C, 100.0f);
+            details.loadCurrent = getValue(0x0D, 100.0f);
+            details.loadPower = getLongValue(0x0E, 100.0f);
+            details.batteryTemperature = getSignedValue(0x10, 100.0f);
+            details.deviceTemperature = getSignedValue(0x11, 100.0f);
+            break;
+
+        case EpeverBlock::Soc:
+            details.batterySoc = node.getResponseBuffer(0x00);
+            break;
+
+        case EpeverBlock::Energy:
+            details.energyAt = TimeBase::getInstance()->getUptime();
+            details.panelVoltageMaxToday = getValue(0x00, 100.0f);
+            details.panelVoltageMinToday = getValue(0x01, 100.0f);
+            details.batteryVoltageMaxToday = getValue(0x02, 100.0f);
+            details.batteryVoltageMinToday = getValue(0x03, 100.0f);
+            details.consumedToday = getLongValue(0x04, 100.0f);
+            details.consumedMonth = getLongValue(0x06, 100.0f);
+            details.consumedYear = getLongValue(0x08, 100.0f);
+            details.consumedTotal = getLongValue(0x0A, 100.0f);
+            details.generatedToday = getLongValue(0x0C, 100.0f);
+            details.generatedMonth = getLongValue(0x0E, 100.0f);
+            details.generatedYear = getLongValue(0x10, 100.0f);
+            details.generatedTotal = getLongValue(0x12, 100.0f);
+            break;
+
+        case EpeverBlock::Battery:
+            // Net battery current, negative while discharging
+            details.batteryCurrent = getSignedLongValue(0x00, 100.0f);
+            break;
+
+        default:
+            break;
+    }
+}
+
+float Epever::getValue(const uint8_t index, const float scale) const {
+    return node.getResponseBuffer(index) / scale;
+}
+
+float Epever::getSignedValue(const uint8_t index, const float scale) const {
+    return static_cast<int16_t>(node.getResponseBuffer(index)) / scale;
+}
+
+// 32 bit values span two registers, low word first
+float Epever::getLongValue(const uint8_t index, const float scale) const {
+    const uint32_t value = node.getResponseBuffer(index) | static_cast<uint32_t>(node.getResponseBuffer(index + 1)) << 16;
+    return value / scale;
+}
+
+float Epever::getSignedLongValue(const uint8_t index, const float scale) const {
+    const uint32_t value = node.getResponseBuffer(index) | static_cast<uint32_t>(node.getResponseBuffer(index + 1)) << 16;
+    return static_cast<int32_t>(value) / scale;
+}
+#endif
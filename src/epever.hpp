@@ -0,0 +1,172 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__EPEVER__H
+#define STATION_MGMT__EPEVER__H
+
+#include <ModbusMaster.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "const.hpp"
+#include "timebase.hpp"
+
+// Input register blocks of the charge controller, each read with a single Modbus transaction: name, first
+// register, register count. The controller answers a read across registers it does not implement with an
+// exception, so the holes at 0x3112-0x3119 and 0x3314-0x331A split the blocks. The position in the table is the
+// param of the Modbus event published when the result of a block changes.
+#ifdef EPEVER_DETAILS_ENABLED
+    #define EPEVER_BLOCKS(X) \
+        X(RealTime, 0x3100, 18) \
+        X(Status, 0x3200, 3) \
+        X(Soc, 0x311A, 1) \
+        X(Energy, 0x3300, 20) \
+        X(Battery, 0x331B, 2)
+#else
+    #define EPEVER_BLOCKS(X) \
+        X(RealTime, 0x3100, 6) \
+        X(Status, 0x3200, 3)
+#endif
+
+#define EPEVER_BLOCK_ENUM(name, address, count) name,
+#define EPEVER_BLOCK_ONE(name, address, count) +1
+#define EPEVER_BLOCKS_NUMBER (0 EPEVER_BLOCKS(EPEVER_BLOCK_ONE))
+
+enum class EpeverBlock : uint8_t { EPEVER_BLOCKS(EPEVER_BLOCK_ENUM) };
+
+#ifdef EPEVER_DETAILS_ENABLED
+// What the telemetry leaves out, decoded from the blocks as they are read
+struct EpeverDetails {
+        uint64_t realTimeAt;
+        float panelPower;
+        float batteryChargePower;
+        float loadVoltage;
+        float loadCurrent;
+        float loadPower;
+        float batteryTemperature;
+        float deviceTemperature;
+        uint8_t batterySoc;
+        float batteryCurrent;
+
+        uint64_t energyAt;
+        float panelVoltageMaxToday;
+        float panelVoltageMinToday;
+        float batteryVoltageMaxToday;
+        float batteryVoltageMinToday;
+        float consumedToday;
+        float consumedMonth;
+        float consumedYear;
+        float consumedTotal;
+        float generatedToday;
+        float generatedMonth;
+        float generatedYear;
+        float generatedTotal;
+};
+#endif
+
+class Epever {
+    public:
+
+        explicit Epever(ModbusMaster& node);
+
+        ~Epever();
+
+        uint8_t read(EpeverBlock block);
+
+        [[nodiscard]]
+        uint8_t getResult(EpeverBlock block) const;
+
+        [[nodiscard]]
+        static uint16_t getAddress(EpeverBlock block);
+
+        [[nodiscard]]
+        static uint8_t getCount(EpeverBlock block);
+
+#ifdef EPEVER_DETAILS_ENABLED
+        [[nodiscard]]
+        const EpeverDetails& getDetails() const;
+
+        template <typename W>
+        size_t serializeDetails(W& writer) const;
+
+        template <typename W>
+        size_t serializeEnergy(W& writer) const;
+#endif
+
+    private:
+
+        ModbusMaster& node;
+
+        uint8_t results[EPEVER_BLOCKS_NUMBER];
+
+#ifdef EPEVER_DETAILS_ENABLED
+        EpeverDetails details;
+
+        void decode(EpeverBlock block);
+
+        float getValue(uint8_t index, float scale) const;
+
+        float getSignedValue(uint8_t index, float scale) const;
+
+        float getLongValue(uint8_t index, float scale) const;
+
+        float getSignedLongValue(uint8_t index, float scale) const;
+#endif
+};
+
+#ifdef EPEVER_DETAILS_ENABLED
+template <typename W>
+size_t Epever::serializeDetails(W& writer) const {
+    size_t size = 0;
+    size += writer.writeValue(TimeBase::getInstance()->toTime(details.realTimeAt));
+    size += writer.writeValue(details.panelPower);
+    size += writer.writeValue(details.batteryChargePower);
+    size += writer.writeValue(details.loadVoltage);
+    size += writer.writeValue(details.loadCurrent);
+    size += writer.writeValue(details.loadPower);
+    size += writer.writeValue(details.batteryTemperature);
+    size += writer.writeValue(details.deviceTemperature);
+    size += writer.writeValue(details.batterySoc);
+    size += writer.writeValue(details.batteryCurrent);
+    return size;
+}
+
+template <typename W>
+size_t Epever::serializeEnergy(W& writer) const {
+    size_t size = 0;
+    size += writer.writeValue(TimeBase::getInstance()->toTime(details.energyAt));
+    size += writer.writeValue(details.panelVoltageMaxToday);
+    size += writer.writeValue(details.panelVoltageMinToday);
+    size += writer.writeValue(details.batteryVoltageMaxToday);
+    size += writer.writeValue(details.batteryVoltageMinToday);
+    size += writer.writeValue(details.consumedToday);
+    size += writer.writeValue(details.consumedMonth);
+    size += writer.writeValue(details.consumedYear);
+    size += writer.writeValue(details.consumedTotal);
+    size += writer.writeValue(details.generatedToday);
+    size += writer.writeValue(details.generatedMonth);
+    size += writer.writeValue(details.generatedYear);
+    size += writer.writeValue(details.generatedTotal);
+    return size;
+}
+#endif
+
+#endif
@@ -0,0 +1,146 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "events.hpp"
+
+#include <Arduino.h>
+
+#include "log.hpp"
+
+Events Events::instance;
+
+Events* Events::getInstance() {
+    return &instance;
+}
+
+Events::Events() {
+    lastSequence = 0;
+    nextReceiver = 0;
+
+    for (EventReceiver& receiver : receivers)
+        receiver.active = false;
+}
+
+Events::~Events() = default;
+
+void Events::publish(const EventCode code, const uint8_t param, const uint8_t value) {
+    // A receiver that was caught up starts its timeout with this event, not with its last acknowledge
+    const unsigned long now = millis();
+    for (EventReceiver& receiver : receivers)
+        if (receiver.active && receiver.ackedSequence == lastSequence)
+            receiver.lastAck = now;
+
+    lastSequence++;
+
+    Event& event = queue[lastSequence % EVENTS_QUEUE_SIZE];
+    event.sequence = lastSequence;
+    event.code = code;
+    event.param = param;
+    event.value = value;
+    event.timestamp = now;
+
+    EventLog::getInstance()->append(code, param, value, TimeBase::getInstance()->getTime());
+}
+
+uint8_t Events::subscribe(const IPAddress& ip, const uint16_t port) {
+    EventReceiver* receiver = findReceiver(ip, port);
+
+    if (receiver == nullptr) {
+        for (EventReceiver& item : receivers) {
+            if (!item.active) {
+                receiver = &item;
+                break;
+            }
+        }
+    }
+
+    if (receiver == nullptr)
+        return EVENTS_RECEIVER_NONE;
+
+    const unsigned long now = millis();
+
+    receiver->active = true;
+    receiver->ip = ip;
+    receiver->port = port;
+    receiver->sentSequence = lastSequence;
+    receiver->ackedSequence = lastSequence;
+    receiver->lastSent = now;
+    receiver->lastAck = now;
+
+    return receiver - receivers;
+}
+
+void Events::unsubscribe(const IPAddress& ip, const uint16_t port) {
+    EventReceiver* receiver = findReceiver(ip, port);
+    if (receiver != nullptr)
+        receiver->active = false;
+}
+
+void Events::acknowledge(const IPAddress& ip, const uint16_t port, const uint16_t sequence) {
+    EventReceiver* receiver = findReceiver(ip, port);
+    if (receiver == nullptr)
+        return;
+
+    // Cumulative acknowledge, ignored if older than the current one or ahead of the published events.
+    // Repeating the current one only tells the receiver is still there.
+    if (static_cast<int16_t>(sequence - receiver->ackedSequence) < 0
+        || static_cast<int16_t>(lastSequence - sequence) < 0)
+        return;
+
+    receiver->ackedSequence = sequence;
+    receiver->lastAck = millis();
+}
+
+uint16_t Events::getLastSequence() const {
+    return lastSequence;
+}
+
+EventReceiver* Events::nextPendingReceiver(const unsigned long now) {
+    for (uint8_t i = 0; i < EVENTS_RECEIVERS_NUMBER; i++) {
+        EventReceiver& receiver = receivers[nextReceiver];
+        nextReceiver = (nextReceiver + 1) % EVENTS_RECEIVERS_NUMBER;
+
+        if (!receiver.active || receiver.ackedSequence == lastSequence)
+            continue;
+
+        if (now - receiver.lastAck > EVENTS_RECEIVER_TIMEOUT) {
+            receiver.active = false;
+            continue;
+        }
+
+        if (receiver.sentSequence != lastSequence || now - receiver.lastSent > EVENTS_RETRANSMIT_INTERVAL)
+            return &receiver;
+    }
+
+    return nullptr;
+}
+
+EventReceiver* Events::findReceiver(const IPAddress& ip, const uint16_t port) {
+    for (EventReceiver& receiver : receivers)
+        if (receiver.active && receiver.ip == ip && receiver.port == port)
+            return &receiver;
+
+    return nullptr;
+}
+
+uint16_t Events::getFirstSequence() const {
+    return lastSequence - EVENTS_QUEUE_SIZE + 1;
+}
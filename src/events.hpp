@@ -0,0 +1,130 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__EVENTS__H
+#define STATION_MGMT__EVENTS__H
+
+#include <IPAddress.h>
+#include <stdint.h>
+
+#include "enums.hpp"
+#include "timebase.hpp"
+
+#define EVENTS_QUEUE_SIZE 16
+#define EVENTS_RECEIVERS_NUMBER 4
+#define EVENTS_RECORD_SIZE 13
+#define EVENTS_RETRANSMIT_INTERVAL 1000
+#define EVENTS_RECEIVER_TIMEOUT 60000
+
+#define EVENTS_RECEIVER_NONE 0xFF
+
+struct Event {
+        uint16_t sequence;
+        EventCode code;
+        uint8_t param;
+        uint8_t value;
+        uint32_t timestamp;
+};
+
+struct EventReceiver {
+        bool active;
+        IPAddress ip;
+        uint16_t port;
+        uint16_t sentSequence;
+        uint16_t ackedSequence;
+        unsigned long lastSent;
+        unsigned long lastAck;
+};
+
+class Events {
+    public:
+
+        static Events* getInstance();
+
+        void publish(EventCode code, uint8_t param, uint8_t value);
+
+        uint8_t subscribe(const IPAddress& ip, uint16_t port);
+
+        void unsubscribe(const IPAddress& ip, uint16_t port);
+
+        void acknowledge(const IPAddress& ip, uint16_t port, uint16_t sequence);
+
+        [[nodiscard]]
+        uint16_t getLastSequence() const;
+
+        EventReceiver* nextPendingReceiver(unsigned long now);
+
+        template <typename W>
+        size_t serialize(EventReceiver* receiver, W& writer, unsigned long now);
+
+    private:
+
+        static Events instance;
+
+        explicit Events();
+
+        ~Events();
+
+        Event queue[EVENTS_QUEUE_SIZE];
+        uint16_t lastSequence;
+
+        EventReceiver receivers[EVENTS_RECEIVERS_NUMBER];
+        uint8_t nextReceiver;
+
+        EventReceiver* findReceiver(const IPAddress& ip, uint16_t port);
+
+        [[nodiscard]]
+        uint16_t getFirstSequence() const;
+};
+
+template <typename W>
+size_t Events::serialize(EventReceiver* receiver, W& writer, const unsigned long now) {
+    const uint16_t firstSequence = getFirstSequence();
+    if (static_cast<int16_t>(receiver->ackedSequence - firstSequence) < 0)
+        receiver->ackedSequence = firstSequence - 1;
+
+    const auto count = static_cast<uint8_t>(lastSequence - receiver->ackedSequence);
+
+    // Queued events keep their millis(), they are reported in the station time of the moment they are sent
+    TimeBase* timeBase = TimeBase::getInstance();
+
+    size_t size = 0;
+    size += writer.writeValue(count);
+
+    uint16_t sequence = receiver->ackedSequence;
+    while (sequence != lastSequence) {
+        sequence++;
+
+        const Event& event = queue[sequence % EVENTS_QUEUE_SIZE];
+        size += writer.writeValue(event.sequence);
+        size += writer.writeValue(event.code);
+        size += writer.writeValue(event.param);
+        size += writer.writeValue(event.value);
+        size += writer.writeValue(timeBase->toTime(timeBase->expand(event.timestamp)));
+    }
+
+    receiver->sentSequence = sequence;
+    receiver->lastSent = now;
+
+    return size;
+}
+
+#endif
@@ -0,0 +1,85 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filter.hpp"
+
+VoltageFilter::VoltageFilter() {
+    windowSize = 1;
+    emaAlpha = 1.0f;
+    reset();
+}
+
+VoltageFilter::~VoltageFilter() = default;
+
+void VoltageFilter::setEmaAlpha(const float newValue) {
+    emaAlpha = newValue;
+}
+
+void VoltageFilter::setMedianSize(const uint8_t newValue) {
+    if (newValue == windowSize)
+        return;
+
+    windowSize = newValue;
+    reset();
+}
+
+float VoltageFilter::push(const float sample) {
+    window[windowIndex] = sample;
+    windowIndex = (windowIndex + 1) % windowSize;
+    if (windowCount < windowSize)
+        windowCount++;
+
+    const float medianValue = median();
+
+    if (initialized) {
+        value += emaAlpha * (medianValue - value);
+    } else {
+        value = medianValue;
+        initialized = true;
+    }
+
+    return value;
+}
+
+float VoltageFilter::getValue() const {
+    return value;
+}
+
+void VoltageFilter::reset() {
+    windowCount = 0;
+    windowIndex = 0;
+    value = 0;
+    initialized = false;
+}
+
+float VoltageFilter::median() const {
+    float sorted[FILTER_MEDIAN_MAX_SIZE];
+
+    for (uint8_t i = 0; i < windowCount; i++) {
+        const float item = window[i];
+        uint8_t j = i;
+        for (; j > 0 && sorted[j - 1] > item; j--)
+            sorted[j] = sorted[j - 1];
+        sorted[j] = item;
+    }
+
+    return sorted[windowCount / 2];
+}
@@ -0,0 +1,62 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__FILTER__H
+#define STATION_MGMT__FILTER__H
+
+#include <stdint.h>
+
+#define FILTER_MEDIAN_MAX_SIZE 5
+
+class VoltageFilter {
+    public:
+
+        VoltageFilter();
+
+        ~VoltageFilter();
+
+        void setEmaAlpha(float newValue);
+
+        void setMedianSize(uint8_t newValue);
+
+        float push(float sample);
+
+        [[nodiscard]]
+        float getValue() const;
+
+        void reset();
+
+    private:
+
+        float window[FILTER_MEDIAN_MAX_SIZE];
+        uint8_t windowSize;
+        uint8_t windowCount;
+        uint8_t windowIndex;
+
+        float emaAlpha;
+        float value;
+        bool initialized;
+
+        [[nodiscard]]
+        float median() const;
+};
+
+#endif
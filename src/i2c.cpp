@@ -0,0 +1,248 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "i2c.hpp"
+
+#include <Arduino.h>
+
+#include "const.hpp"
+
+#ifdef I2C_ENABLED
+    #ifdef __AVR__
+        #include <avr/interrupt.h>
+        #include <util/twi.h>
+
+        #define TWCR_ENABLE (_BV(TWEN) | _BV(TWIE) | _BV(TWINT))
+
+ISR(TWI_vect) {
+    I2cBus::getInstance()->onInterrupt();
+}
+    #endif
+
+I2cBus I2cBus::instance;
+
+I2cBus* I2cBus::getInstance() {
+    return &instance;
+}
+
+I2cBus::I2cBus() {
+    queueHead = 0;
+    queueCount = 0;
+    active = nullptr;
+    txIndex = 0;
+    rxIndex = 0;
+    started = 0;
+    timeouts = 0;
+    recoveries = 0;
+}
+
+I2cBus::~I2cBus() = default;
+
+void I2cBus::begin() {
+    #ifdef __AVR__
+    // A slave left mid-byte by a reset keeps SDA low until it is clocked out
+    pinMode(SDA, INPUT_PULLUP);
+    pinMode(SCL, INPUT_PULLUP);
+    if (digitalRead(SDA) == LOW)
+        recoverBus();
+    #endif
+
+    configure();
+}
+
+bool I2cBus::submit(I2cTransaction* transaction) {
+    if (queueCount == I2C_QUEUE_SIZE)
+        return false;
+
+    if (transaction->timeout == 0)
+        transaction->timeout = I2C_DEFAULT_TIMEOUT;
+    transaction->result = I2cResult::Pending;
+
+    queue[(queueHead + queueCount) % I2C_QUEUE_SIZE] = transaction;
+    queueCount++;
+
+    return true;
+}
+
+void I2cBus::poll() {
+    I2cTransaction* transaction = active;
+
+    if (transaction != nullptr) {
+        if (transaction->result == I2cResult::Pending) {
+            if (millis() - started <= transaction->timeout)
+                return;
+
+            timeouts++;
+            recoverBus();
+            configure();
+            transaction->result = I2cResult::Timeout;
+        }
+
+        // Callbacks run here, in loop context, so they are free to submit the next step
+        active = nullptr;
+        if (transaction->callback != nullptr)
+            transaction->callback(*transaction);
+    }
+
+    if (queueCount == 0)
+        return;
+
+    #ifdef __AVR__
+    // The STOP of the previous transaction is still on the wire
+    if (TWCR & _BV(TWSTO))
+        return;
+    #endif
+
+    active = queue[queueHead];
+    queueHead = (queueHead + 1) % I2C_QUEUE_SIZE;
+    queueCount--;
+
+    start();
+}
+
+void I2cBus::onInterrupt() {
+    #ifdef __AVR__
+    I2cTransaction* transaction = active;
+    if (transaction == nullptr) {
+        TWCR = _BV(TWEN) | _BV(TWINT);
+        return;
+    }
+
+    switch (TW_STATUS) {
+        case TW_START:
+        case TW_REP_START:
+            if (txIndex < transaction->txSize || transaction->rxSize == 0)
+                TWDR = TW_WRITE | (transaction->address << 1);
+            else
+                TWDR = TW_READ | (transaction->address << 1);
+            TWCR = TWCR_ENABLE;
+            break;
+
+        case TW_MT_SLA_ACK:
+        case TW_MT_DATA_ACK:
+            if (txIndex < transaction->txSize) {
+                TWDR = transaction->txData[txIndex];
+                txIndex++;
+                TWCR = TWCR_ENABLE;
+            } else if (transaction->rxSize > 0) {
+                TWCR = TWCR_ENABLE | _BV(TWSTA);
+            } else {
+                finish(I2cResult::Success);
+            }
+            break;
+
+        case TW_MR_SLA_ACK:
+            TWCR = transaction->rxSize > 1 ? TWCR_ENABLE | _BV(TWEA) : TWCR_ENABLE;
+            break;
+
+        case TW_MR_DATA_ACK:
+            transaction->rxData[rxIndex] = TWDR;
+            rxIndex++;
+            TWCR = rxIndex + 1 < transaction->rxSize ? TWCR_ENABLE | _BV(TWEA) : TWCR_ENABLE;
+            break;
+
+        case TW_MR_DATA_NACK:
+            transaction->rxData[rxIndex] = TWDR;
+            rxIndex++;
+            finish(I2cResult::Success);
+            break;
+
+        case TW_MT_SLA_NACK:
+        case TW_MR_SLA_NACK:
+            finish(I2cResult::AddressNack);
+            break;
+
+        case TW_MT_DATA_NACK:
+            finish(I2cResult::DataNack);
+            break;
+
+        case TW_MT_ARB_LOST:
+            TWCR = _BV(TWEN) | _BV(TWINT);
+            transaction->result = I2cResult::ArbitrationLost;
+            break;
+
+        default:
+            finish(I2cResult::BusError);
+            break;
+    }
+    #endif
+}
+
+uint16_t I2cBus::getTimeouts() const {
+    return timeouts;
+}
+
+uint16_t I2cBus::getRecoveries() const {
+    return recoveries;
+}
+
+void I2cBus::start() {
+    txIndex = 0;
+    rxIndex = 0;
+    started = millis();
+
+    #ifdef __AVR__
+    TWCR = TWCR_ENABLE | _BV(TWSTA);
+    #else
+    active->result = I2cResult::BusError;
+    #endif
+}
+
+void I2cBus::finish(const I2cResult result) {
+    #ifdef __AVR__
+    // STOP completes in hardware, poll() waits for it before the next START
+    TWCR = _BV(TWEN) | _BV(TWINT) | _BV(TWSTO);
+    #endif
+    active->result = result;
+}
+
+void I2cBus::configure() {
+    #ifdef __AVR__
+    TWSR = 0;
+    TWBR = ((F_CPU / I2C_FREQUENCY) - 16) / 2;
+    TWCR = _BV(TWEN) | _BV(TWIE);
+    #endif
+}
+
+void I2cBus::recoverBus() {
+    recoveries++;
+
+    #ifdef __AVR__
+    TWCR = 0;
+
+    pinMode(SDA, INPUT_PULLUP);
+    for (uint8_t i = 0; i < I2C_RECOVERY_CLOCKS && digitalRead(SDA) == LOW; i++) {
+        digitalWrite(SCL, LOW);
+        pinMode(SCL, OUTPUT);
+        delayMicroseconds(I2C_RECOVERY_HALF_PERIOD);
+        pinMode(SCL, INPUT_PULLUP);
+        delayMicroseconds(I2C_RECOVERY_HALF_PERIOD);
+    }
+
+    // A STOP puts every slave state machine back to idle
+    digitalWrite(SDA, LOW);
+    pinMode(SDA, OUTPUT);
+    delayMicroseconds(I2C_RECOVERY_HALF_PERIOD);
+    pinMode(SDA, INPUT_PULLUP);
+    delayMicroseconds(I2C_RECOVERY_HALF_PERIOD);
+    #endif
+}
+#endif
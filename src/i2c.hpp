@@ -0,0 +1,108 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__I2C__H
+#define STATION_MGMT__I2C__H
+
+#include <stdint.h>
+
+#define I2C_FREQUENCY 100000UL
+#define I2C_QUEUE_SIZE 4
+#define I2C_DEFAULT_TIMEOUT 25
+#define I2C_RECOVERY_CLOCKS 9
+#define I2C_RECOVERY_HALF_PERIOD 5
+
+enum class I2cResult : uint8_t {
+    Idle = 0x00,
+    Pending = 0x01,
+    Success = 0x02,
+    AddressNack = 0x03,
+    DataNack = 0x04,
+    ArbitrationLost = 0x05,
+    BusError = 0x06,
+    Timeout = 0x07
+};
+
+struct I2cTransaction;
+
+using I2cCallback = void (*)(I2cTransaction& transaction);
+
+struct I2cTransaction {
+        uint8_t address;
+        const uint8_t* txData;
+        uint8_t txSize;
+        uint8_t* rxData;
+        uint8_t rxSize;
+        uint16_t timeout;
+        I2cCallback callback;
+        void* context;
+        volatile I2cResult result;
+};
+
+class I2cBus {
+    public:
+
+        static I2cBus* getInstance();
+
+        void begin();
+
+        bool submit(I2cTransaction* transaction);
+
+        void poll();
+
+        void onInterrupt();
+
+        [[nodiscard]]
+        uint16_t getTimeouts() const;
+
+        [[nodiscard]]
+        uint16_t getRecoveries() const;
+
+    private:
+
+        static I2cBus instance;
+
+        explicit I2cBus();
+
+        ~I2cBus();
+
+        I2cTransaction* queue[I2C_QUEUE_SIZE];
+        uint8_t queueHead;
+        uint8_t queueCount;
+
+        I2cTransaction* volatile active;
+        volatile uint8_t txIndex;
+        volatile uint8_t rxIndex;
+        unsigned long started;
+
+        uint16_t timeouts;
+        uint16_t recoveries;
+
+        void start();
+
+        void finish(I2cResult result);
+
+        void configure();
+
+        void recoverBus();
+};
+
+#endif
@@ -0,0 +1,153 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ina219.hpp"
+
+#include <string.h>
+
+#include "const.hpp"
+
+#ifdef SENSOR_INA219_ENABLED
+Ina219::Ina219(const uint8_t address, const float shuntResistance) {
+    this->address = address;
+    this->shuntResistance = shuntResistance;
+    state = State::Configure;
+    success = false;
+
+    memset(&transaction, 0, sizeof(I2cTransaction));
+    transaction.result = I2cResult::Idle;
+
+    shuntVoltage = 0;
+    busVoltage = 0;
+}
+
+Ina219::~Ina219() = default;
+
+void Ina219::init() {
+    state = State::Configure;
+
+    txBuffer[0] = INA219_REGISTER_CONFIG;
+    txBuffer[1] = INA219_CONFIG_VALUE >> 8;
+    txBuffer[2] = INA219_CONFIG_VALUE & 0xFF;
+    request(3, 0);
+}
+
+bool Ina219::startConversion() {
+    if (transaction.result == I2cResult::Pending)
+        return false;
+
+    if (state == State::Configure) {
+        init();
+        return false;
+    }
+
+    // Registers do not auto-increment, shunt and bus are read in two chained transactions
+    state = State::ReadShunt;
+    success = false;
+    txBuffer[0] = INA219_REGISTER_SHUNT_VOLTAGE;
+    request(1, 2);
+    return true;
+}
+
+bool Ina219::isReady() {
+    return state == State::Done || state == State::Configure;
+}
+
+uint8_t Ina219::read(float* values) {
+    if (!success)
+        return 0;
+
+    const float current = shuntVoltage / shuntResistance;
+
+    values[0] = busVoltage;
+    values[1] = current;
+    values[2] = busVoltage * current;
+    return INA219_CHANNELS;
+}
+
+SensorType Ina219::getType() const {
+    return SensorType::Ina219;
+}
+
+uint8_t Ina219::getChannelCount() const {
+    return INA219_CHANNELS;
+}
+
+SensorQuantity Ina219::getQuantity(const uint8_t channel) const {
+    switch (channel) {
+        case 0:
+            return SensorQuantity::Voltage;
+        case 1:
+            return SensorQuantity::Current;
+        default:
+            return SensorQuantity::Power;
+    }
+}
+
+void Ina219::request(const uint8_t txSize, const uint8_t rxSize) {
+    transaction.address = address;
+    transaction.txData = txBuffer;
+    transaction.txSize = txSize;
+    transaction.rxData = rxBuffer;
+    transaction.rxSize = rxSize;
+    transaction.timeout = 0;
+    transaction.callback = onComplete;
+    transaction.context = this;
+
+    if (!I2cBus::getInstance()->submit(&transaction))
+        state = State::Configure;
+}
+
+uint16_t Ina219::getRegister() const {
+    return (rxBuffer[0] << 8) | rxBuffer[1];
+}
+
+void Ina219::onComplete(I2cTransaction& transaction) {
+    auto* sensor = static_cast<Ina219*>(transaction.context);
+
+    if (transaction.result != I2cResult::Success) {
+        sensor->state = State::Configure;
+        return;
+    }
+
+    switch (sensor->state) {
+        case State::Configure:
+            sensor->state = State::Idle;
+            break;
+
+        case State::ReadShunt:
+            sensor->shuntVoltage = static_cast<int16_t>(sensor->getRegister()) * INA219_SHUNT_VOLTAGE_LSB;
+            sensor->state = State::ReadBus;
+            sensor->txBuffer[0] = INA219_REGISTER_BUS_VOLTAGE;
+            sensor->request(1, 2);
+            break;
+
+        case State::ReadBus:
+            sensor->busVoltage = (sensor->getRegister() >> 3) * INA219_BUS_VOLTAGE_LSB;
+            sensor->success = true;
+            sensor->state = State::Done;
+            break;
+
+        default:
+            break;
+    }
+}
+#endif
@@ -0,0 +1,95 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__INA219__H
+#define STATION_MGMT__INA219__H
+
+#include <stdint.h>
+
+#include "i2c.hpp"
+#include "sensors.hpp"
+
+#define INA219_REGISTER_CONFIG 0x00
+#define INA219_REGISTER_SHUNT_VOLTAGE 0x01
+#define INA219_REGISTER_BUS_VOLTAGE 0x02
+
+// 32 V bus range, 320 mV shunt range, 12 bit, continuous shunt and bus
+#define INA219_CONFIG_VALUE 0x399F
+
+#define INA219_SHUNT_VOLTAGE_LSB 0.00001f
+#define INA219_BUS_VOLTAGE_LSB 0.004f
+#define INA219_CHANNELS 3
+
+class Ina219 : public SensorDriver {
+    public:
+
+        Ina219(uint8_t address, float shuntResistance);
+
+        ~Ina219() override;
+
+        void init() override;
+
+        bool startConversion() override;
+
+        bool isReady() override;
+
+        uint8_t read(float* values) override;
+
+        [[nodiscard]]
+        SensorType getType() const override;
+
+        [[nodiscard]]
+        uint8_t getChannelCount() const override;
+
+        [[nodiscard]]
+        SensorQuantity getQuantity(uint8_t channel) const override;
+
+    private:
+
+        enum class State : uint8_t {
+            Configure,
+            Idle,
+            ReadShunt,
+            ReadBus,
+            Done
+        };
+
+        uint8_t address;
+        float shuntResistance;
+        State state;
+        bool success;
+
+        I2cTransaction transaction;
+        uint8_t txBuffer[3];
+        uint8_t rxBuffer[2];
+
+        float shuntVoltage;
+        float busVoltage;
+
+        void request(uint8_t txSize, uint8_t rxSize);
+
+        [[nodiscard]]
+        uint16_t getRegister() const;
+
+        static void onComplete(I2cTransaction& transaction);
+};
+
+#endif
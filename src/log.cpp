@@ -0,0 +1,135 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "log.hpp"
+
+#include <Arduino.h>
+#include <EEPROM.h>
+
+#include "eeprom.hpp"
+
+static_assert(sizeof(LogRecord) == EVENT_LOG_RECORD_SIZE, "LogRecord must be packed");
+
+EventLog EventLog::instance;
+
+EventLog* EventLog::getInstance() {
+    return &instance;
+}
+
+EventLog::EventLog() {
+    bufferCount = 0;
+    head = 0;
+    count = 0;
+    nextSequence = 0;
+}
+
+EventLog::~EventLog() = default;
+
+void EventLog::begin() {
+    const uint16_t capacity = getCapacity();
+
+    // Records of an older layout cannot be read back, the log starts over empty. Every slot is erased, a leftover
+    // record would read as a break in the chain once the first new ones are written.
+    if (EEPROM.read(EEPROM_ADDRESS_LOG_LAYOUT) != EVENT_LOG_LAYOUT_VERSION) {
+        for (uint16_t slot = 0; slot < capacity; slot++)
+            for (uint8_t i = 0; i < sizeof(uint16_t); i++)
+                EEPROM.update(EEPROM_ADDRESS_LOG_START + slot * EVENT_LOG_RECORD_SIZE + i, 0xFF);
+        EEPROM.update(EEPROM_ADDRESS_LOG_LAYOUT, EVENT_LOG_LAYOUT_VERSION);
+        return;
+    }
+
+    LogRecord record;
+    readRecord(0, record);
+    if (record.sequence == EVENT_LOG_SEQUENCE_EMPTY)
+        return;
+
+    // Records are written with consecutive sequences, the head is the first break in the chain
+    uint16_t previousSequence = record.sequence;
+    head = 0;
+    count = capacity;
+    for (uint16_t slot = 1; slot < capacity; slot++) {
+        readRecord(slot, record);
+        if (record.sequence != incrementSequence(previousSequence)) {
+            head = slot;
+            if (record.sequence == EVENT_LOG_SEQUENCE_EMPTY)
+                count = slot;
+            break;
+        }
+        previousSequence = record.sequence;
+    }
+
+    nextSequence = incrementSequence(previousSequence);
+}
+
+void EventLog::append(const EventCode code, const uint8_t param, const uint8_t value, const uint64_t timestamp) {
+    LogRecord& record = buffer[bufferCount];
+    record.sequence = nextSequence;
+    record.code = code;
+    record.param = param;
+    record.value = value;
+    record.timestamp = timestamp;
+
+    nextSequence = incrementSequence(nextSequence);
+    bufferCount++;
+
+    if (bufferCount == EVENT_LOG_BUFFER_SIZE)
+        flush();
+}
+
+void EventLog::flush() {
+    const uint16_t capacity = getCapacity();
+
+    for (uint8_t i = 0; i < bufferCount; i++) {
+        writeRecord(head, buffer[i]);
+        head = (head + 1) % capacity;
+        if (count < capacity)
+            count++;
+    }
+
+    bufferCount = 0;
+}
+
+uint16_t EventLog::getCount() const {
+    return count + bufferCount;
+}
+
+uint16_t EventLog::getCapacity() {
+    return (EEPROM_ADDRESS_LOG_END - EEPROM_ADDRESS_LOG_START) / EVENT_LOG_RECORD_SIZE;
+}
+
+uint16_t EventLog::incrementSequence(const uint16_t sequence) {
+    const uint16_t next = sequence + 1;
+    return next == EVENT_LOG_SEQUENCE_EMPTY ? 0 : next;
+}
+
+void EventLog::readRecord(const uint16_t slot, LogRecord& record) {
+    const int address = EEPROM_ADDRESS_LOG_START + slot * EVENT_LOG_RECORD_SIZE;
+    auto* recordPointer = reinterpret_cast<uint8_t*>(&record);
+    for (uint8_t i = 0; i < EVENT_LOG_RECORD_SIZE; i++)
+        recordPointer[i] = EEPROM.read(address + i);
+}
+
+void EventLog::writeRecord(const uint16_t slot, const LogRecord& record) {
+    const int address = EEPROM_ADDRESS_LOG_START + slot * EVENT_LOG_RECORD_SIZE;
+    auto* recordPointer = reinterpret_cast<const uint8_t*>(&record);
+    for (uint8_t i = 0; i < EVENT_LOG_RECORD_SIZE; i++)
+        EEPROM.update(address + i, recordPointer[i]);
+}
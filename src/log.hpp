@@ -0,0 +1,119 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__LOG__H
+#define STATION_MGMT__LOG__H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "enums.hpp"
+
+#define EVENT_LOG_BUFFER_SIZE 4
+#define EVENT_LOG_PAGE_SIZE 16
+#define EVENT_LOG_RECORD_SIZE 13
+#define EVENT_LOG_LAYOUT_VERSION 0x02
+#define EVENT_LOG_SEQUENCE_EMPTY 0xFFFF
+
+struct __attribute__((packed)) LogRecord {
+        uint16_t sequence;
+        EventCode code;
+        uint8_t param;
+        uint8_t value;
+        uint64_t timestamp;
+};
+
+class EventLog {
+    public:
+
+        static EventLog* getInstance();
+
+        void begin();
+
+        void append(EventCode code, uint8_t param, uint8_t value, uint64_t timestamp);
+
+        void flush();
+
+        [[nodiscard]]
+        uint16_t getCount() const;
+
+        template <typename W>
+        size_t serializePage(uint16_t page, W& writer);
+
+    private:
+
+        static EventLog instance;
+
+        explicit EventLog();
+
+        ~EventLog();
+
+        LogRecord buffer[EVENT_LOG_BUFFER_SIZE];
+        uint8_t bufferCount;
+
+        uint16_t head;
+        uint16_t count;
+        uint16_t nextSequence;
+
+        static uint16_t getCapacity();
+
+        static uint16_t incrementSequence(uint16_t sequence);
+
+        static void readRecord(uint16_t slot, LogRecord& record);
+
+        static void writeRecord(uint16_t slot, const LogRecord& record);
+};
+
+template <typename W>
+size_t EventLog::serializePage(const uint16_t page, W& writer) {
+    flush();
+
+    const uint16_t capacity = getCapacity();
+
+    // Page 0 holds the most recent records
+    const uint32_t first = static_cast<uint32_t>(page) * EVENT_LOG_PAGE_SIZE;
+    uint32_t last = first + EVENT_LOG_PAGE_SIZE;
+    if (last > count)
+        last = count;
+    const auto pageCount = static_cast<uint8_t>(last > first ? last - first : 0);
+
+    size_t size = 0;
+    size += writer.writeValue(page);
+    size += writer.writeValue(count);
+    size += writer.writeValue(pageCount);
+
+    for (uint32_t i = first; i < last; i++) {
+        const uint16_t slot = (head + capacity - 1 - i) % capacity;
+
+        LogRecord record;
+        readRecord(slot, record);
+
+        size += writer.writeValue(record.sequence);
+        size += writer.writeValue(record.code);
+        size += writer.writeValue(record.param);
+        size += writer.writeValue(record.value);
+        size += writer.writeValue(record.timestamp);
+    }
+
+    return size;
+}
+
+#endif
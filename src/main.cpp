@@ -24,37 +24,79 @@
 #include <Arduino.h>
 #include <Ethernet.h>
 #include <ModbusMaster.h>
-#include <Wire.h>
 
+#include "cache.hpp"
 #include "config.hpp"
 #include "const.hpp"
+#include "diagnostics.hpp"
 #include "enums.hpp"
+#include "epever.hpp"
+#include "events.hpp"
+#include "filter.hpp"
+#include "log.hpp"
+#include "network.hpp"
 #include "protocol.hpp"
-#include "relais.hpp"
+#include "timebase.hpp"
 #include "utils.hpp"
 #include "version.hpp"
 
+#ifdef I2C_ENABLED
+    #include "i2c.hpp"
+#endif
+
+#ifdef SENSORS_ENABLED
+    #include "sensors.hpp"
+#endif
+
+#ifdef RELAIS_ENABLED
+    #include "relais.hpp"
+    #include "shedder.hpp"
+    #include "switcher.hpp"
+#endif
+
+#ifdef STATISTICS_ENABLED
+    #include "stats.hpp"
+#endif
+
+#ifdef SD_LOGGER_ENABLED
+    #include "sdlog.hpp"
+#endif
+
 #ifdef RTC_DS3231_ENABLED
-    #include <DS3231.h>
-DS3231 rtc;
+    #include "ds3231.hpp"
+Ds3231 rtc;
 #endif
 
 #ifdef SENSOR_BMP280_ENABLED
-    #include <Adafruit_BMP280.h>
-Adafruit_BMP280 bmp;
+    #include "bmp280.hpp"
+Bmp280 bmp(SENSOR_BMP280_ADDRESS);
+#endif
+
+#ifdef SENSOR_INA219_ENABLED
+    #include "ina219.hpp"
+Ina219 ina(SENSOR_INA219_ADDRESS, SENSOR_INA219_SHUNT);
+#endif
+
+#ifdef TRACE_ENABLED
+    #include "trace.hpp"
+Trace* trace;
 #endif
 
 Config config;
 
 ModbusMaster node;
+Epever epever(node);
+
+#ifdef EPEVER_DETAILS_ENABLED
+EpeverBlock nextDetailsBlock = EpeverBlock::Soc;
+#endif
 
 float panelVoltage;
 float panelCurrent;
 float batteryVoltage;
+float batteryVoltageFiltered;
 float batteryChargeCurrent;
-
-float bmpTemp;
-float bmpPressure;
+uint64_t telemetrySampledAt;
 
 bool statusWrongVoltageIdentification;
 Temperature statusTemperature;
@@ -63,63 +105,145 @@ Charging statusCharging;
 Arrays statusArrays;
 Load statusLoad;
 
-EthernetUDP udp;
+StreamingUDP udp;
+
+#ifdef I2C_ENABLED
+I2cBus* i2c;
+#endif
+
+TimeBase* timeBase;
+
+#ifdef SENSORS_ENABLED
+Sensors* sensors;
+#endif
+
+#ifdef METEO_ENABLED
+uint8_t meteoSensor;
+uint64_t meteoSampledAt;
+#endif
 
+#ifdef RELAIS_ENABLED
 Relais* relais;
 
+LoadShedder shedder;
+RelaisSwitcher switcher;
+#endif
+
+Events* events;
+
+EventLog* eventLog;
+
+#ifdef SD_LOGGER_ENABLED
+SdLogger sdLogger;
+#endif
+
+VoltageFilter batteryVoltageFilter;
+unsigned long batteryVoltageLowSince;
+
+#ifdef STATISTICS_ENABLED
+Statistics statistics;
+#endif
+
+Diagnostics diagnostics;
+
+ResponseCache<PROTOCOL_TELEMETRY_SIZE> telemetryCache;
+ResponseCache<PROTOCOL_STATUS_SIZE> statusCache;
+#ifdef METEO_ENABLED
+ResponseCache<PROTOCOL_METEO_SIZE> meteoCache;
+#endif
+
 declareLastExecution(ReceiveCommand);
 
-#ifdef SENSOR_BMP280_ENABLED
-declareLastExecution(ReadBMP);
+#ifdef SENSORS_ENABLED
+declareLastExecution(AcquireSensors);
+#endif
+
+#ifdef RTC_DS3231_ENABLED
+declareLastExecution(ReadRTC);
 #endif
 
 declareLastExecution(ReadEpeverData);
 declareLastExecution(ReadEpeverStatus);
-declareLastExecution(EvaluateGlobalStatus);
-declareLastExecution(EvaluateRelais);
+
+#ifdef EPEVER_DETAILS_ENABLED
+declareLastExecution(ReadEpeverDetails);
+declareLastExecution(ReadEpeverEnergy);
+#endif
+
+#ifdef DIAGNOSTICS_ENABLED
+declareLastExecution(ScanMemory);
+#endif
+
+declareLastExecution(SendBeacon);
+declareLastExecution(SendEvents);
+declareLastExecution(FlushEventLog);
+
+#ifdef SD_LOGGER_ENABLED
+declareLastExecution(FlushSdLog);
+#endif
+
+#ifdef TRACE_TO_SD
+declareLastExecution(FlushTrace);
+#endif
 
 bool globalStatus;
 
+#ifdef RELAIS_ENABLED
 int relaisPins[RELAIS_NUMBER] RELAIS_CHANNEL_PINS;
+#endif
+
+char requestPacket[NETWORK_BUFFER_SIZE];
 
 bool executeReset;
+bool executeEvaluation;
 
 void setup() {
+#ifndef MODBUS_ON_CONSOLE
     Serial.begin(115200);
 
-    Serial.println("################################");
-    Serial.println(__TIMESTAMP__);
-    Serial.print("Firmware version: ");
-    Serial.println(FIRMWARE_VERSION);
+    Serial.println(F("################################"));
+    Serial.println(F(__TIMESTAMP__));
+    Serial.print(F("Firmware version: "));
+    Serial.println(F(FIRMWARE_VERSION));
+    Serial.print(F("Reset cause: 0x"));
+    Serial.println(diagnostics.getResetCause(), HEX);
     Serial.println();
     Serial.flush();
+#endif
 
-    serialDebug("Configuring Ethernet shield pins... ");
+    serialDebugF("Configuring Ethernet shield pins... ");
     pinMode(PIN_ETHERNET_SD_ENABLE, OUTPUT);
     pinMode(PIN_ETHERNET_NET_ENABLE, OUTPUT);
 
+#ifdef SD_LOGGER_ENABLED
+    digitalWrite(PIN_ETHERNET_SD_ENABLE, HIGH);
+#else
     digitalWrite(PIN_ETHERNET_SD_ENABLE, LOW);
+#endif
     digitalWrite(PIN_ETHERNET_NET_ENABLE, HIGH);
-    serialDebugln("done");
+    serialDebuglnF("done");
 
-    serialDebug("Configuring Wire... ");
-    Wire.begin();
-    serialDebugln("done");
+#ifdef I2C_ENABLED
+    serialDebugF("Configuring I2C bus... ");
+    i2c = I2cBus::getInstance();
+    i2c->begin();
+    serialDebuglnF("done");
+#endif
 
-    serialDebug("Configuring EpeverClient... ");
+    serialDebugF("Configuring EpeverClient... ");
     pinMode(PIN_EPEVER_RE, OUTPUT);
     pinMode(PIN_EPEVER_DE, OUTPUT);
 
     modbusPostTransmission();
 
-    Serial2.begin(MODBUS_BAUDRATE);
+    MODBUS_SERIAL.begin(MODBUS_BAUDRATE);
 
     node.preTransmission(modbusPreTransmission);
     node.postTransmission(modbusPostTransmission);
-    node.begin(MODBUS_CLIENT_ID, Serial2);
-    serialDebugln("done");
+    node.begin(MODBUS_CLIENT_ID, MODBUS_SERIAL);
+    serialDebuglnF("done");
 
-    serialDebug("Configuring NetworkProtocol... ");
+    serialDebugF("Configuring NetworkProtocol... ");
     constexpr uint8_t mac[] NETWORK_MAC_ADDRESS;
     IPAddress networkIp;
     networkIp.fromString(NETWORK_IP);
@@ -131,416 +255,990 @@ void setup() {
     networkSubnet.fromString(NETWORK_SUBNET);
     EthernetClass::begin(const_cast<uint8_t*>(mac), networkIp, networkDns, networkGateway, networkSubnet);
     udp.begin(NETWORK_UDP_PORT);
-    serialDebugln("done");
+    serialDebuglnF("done");
+
+#ifdef SD_LOGGER_ENABLED
+    serialDebugF("Configuring SD logger... ");
+    if (sdLogger.begin()) {
+        serialDebugF("card ready");
+    } else {
+        serialDebugF("no card");
+    }
+    serialDebuglnF(" | done");
+#endif
+
+#ifdef TRACE_ENABLED
+    serialDebugF("Configuring Trace... ");
+    trace = Trace::getInstance();
+    #ifdef TRACE_TO_SD
+    trace->begin(sdLogger.getDevice());
+    #else
+    trace->begin(nullptr);
+    #endif
+    trace->recordBoot(diagnostics.getResetCause());
+    serialDebuglnF("done");
+#endif
 
 #ifdef RTC_DS3231_ENABLED
-    serialDebug("Configuring Clock... ");
-    rtc.setClockMode(false);
-    serialDebugln("done");
+    serialDebugF("Configuring Clock... ");
+    rtc.update();
+    serialDebuglnF("done");
 #endif
 
-#ifdef SENSOR_BMP280_ENABLED
-    serialDebug("Configuring BMP280... ");
-    bmp.begin(SENSOR_BMP280_ADDRESS);
+    timeBase = TimeBase::getInstance();
+
+#ifdef SENSORS_ENABLED
+    serialDebugF("Configuring Sensors... ");
+    sensors = Sensors::getInstance();
+    #ifdef SENSOR_BMP280_ENABLED
+    sensors->add(&bmp);
+    #endif
+    #ifdef SENSOR_INA219_ENABLED
+    sensors->add(&ina);
+    #endif
+    #ifdef METEO_ENABLED
+    meteoSensor = sensors->find(SensorType::Bmp280);
+    #endif
+    sensors->begin();
+    serialDebugF("Count: ");
+    serialDebug(sensors->getCount());
+    serialDebuglnF(" | done");
+#endif
 
-    serialDebug("Sensor ID: ");
-    serialDebug(bmp.sensorID());
+    serialDebugF("Configuring battery voltage filter... ");
+    applyConfig();
+    batteryVoltageLowSince = 0;
+    serialDebuglnF("done");
 
-    bmp.setSampling(
-        Adafruit_BMP280::MODE_NORMAL,     /* Operating Mode. */
-        Adafruit_BMP280::SAMPLING_X2,     /* Temp. oversampling */
-        Adafruit_BMP280::SAMPLING_X16,    /* Pressure oversampling */
-        Adafruit_BMP280::FILTER_X16,      /* Filtering. */
-        Adafruit_BMP280::STANDBY_MS_500); /* Standby time. */
-    serialDebugln(" | done");
-#endif
+    serialDebugF("Configuring Event log... ");
+    eventLog = EventLog::getInstance();
+    eventLog->begin();
+    serialDebugF("Records: ");
+    serialDebug(eventLog->getCount());
+    serialDebuglnF(" | done");
+
+    serialDebugF("Configuring Events... ");
+    events = Events::getInstance();
+    events->publish(EventCode::Reset, 0, diagnostics.getResetCause());
+    serialDebuglnF("done");
 
-    serialDebug("Configuring Relais... ");
-    relais = Relais::getInstance();
     globalStatus = false;
-    serialDebugln("done");
 
-    serialDebug("Configuring Relais pins... ");
+#ifdef RELAIS_ENABLED
+    serialDebugF("Configuring Relais... ");
+    relais = Relais::getInstance();
+    serialDebuglnF("done");
+
+    serialDebugF("Configuring Relais pins... ");
     for (const int pin : relaisPins) {
         pinMode(pin, OUTPUT);
         digitalWrite(pin, HIGH);
     }
     rainbow();
-    serialDebugln("done");
+    switcher.begin(relaisPins);
+    serialDebuglnF("done");
+#endif
 
     executeReset = false;
+    executeEvaluation = false;
 }
 
 void loop() {
+    benchmarkBegin(Loop);
+
     getCurrentMillis();
+    timeBase->poll();
+
+#ifdef I2C_ENABLED
+    i2c->poll();
+#endif
+
+#ifdef SENSORS_ENABLED
+    const uint8_t updatedSensors = sensors->poll();
+    if (updatedSensors != 0) {
+    #ifdef METEO_ENABLED
+        if (meteoSensor != SENSORS_NONE && (updatedSensors & (1 << meteoSensor)) != 0)
+            meteoSampledAt = timeBase->getUptime();
+        meteoCache.invalidate();
+    #endif
+    #ifdef TRACE_ENABLED
+        traceSensors(updatedSensors);
+    #endif
+    }
+#endif
 
     executeEvery(ReceiveCommand, 250);
 
-#ifdef SENSOR_BMP280_ENABLED
-    executeEvery(ReadBMP, 1000);
+#ifdef SENSORS_ENABLED
+    executeEvery(AcquireSensors, 1000);
+#endif
+
+#ifdef RTC_DS3231_ENABLED
+    executeEvery(ReadRTC, 60000);
 #endif
 
     executeEvery(ReadEpeverData, 1000);
     executeEvery(ReadEpeverStatus, 5000);
-    executeEvery(EvaluateGlobalStatus, 1000);
-    executeEvery(EvaluateRelais, 1000);
+
+#ifdef EPEVER_DETAILS_ENABLED
+    executeEvery(ReadEpeverDetails, 2500);
+    executeEvery(ReadEpeverEnergy, 60000);
+#endif
+
+#ifdef DIAGNOSTICS_ENABLED
+    executeEvery(ScanMemory, 10000);
+#endif
+
+    executeEvery(SendBeacon, config.getBeaconPeriod() * 1000UL);
+    executeEvery(SendEvents, 50);
+    executeEvery(FlushEventLog, 30000);
+
+#ifdef SD_LOGGER_ENABLED
+    executeEvery(FlushSdLog, 100);
+#endif
+
+#ifdef TRACE_TO_SD
+    executeEvery(FlushTrace, 100);
+#endif
+
+#ifdef RELAIS_ENABLED
+    switcher.poll(shedder, clockNow);
+
+    // The inrush of a load just switched on would read as a discharged battery, the threshold evaluation waits until
+    // the sequence has settled and then runs once on a steady voltage
+    const bool settled = !switcher.isSettling();
+#else
+    const bool settled = true;
+#endif
+
+    if (executeEvaluation && settled) {
+        executeEvaluation = false;
+        benchmarkBegin(Evaluation);
+        doEvaluateGlobalStatus();
+#ifdef RELAIS_ENABLED
+        doEvaluateRelais();
+#endif
+        benchmarkEnd(Evaluation);
+    }
 
     if (executeReset) {
         executeReset = false;
+        eventLog->flush();
         resetFunc();
     }
+
+    benchmarkEnd(Loop);
 }
 
 void doReceiveCommand() {
+    // The request stays in the RX buffer until the previous response has left the socket
+    if (udp.isSending())
+        return;
+
     if (udp.parsePacket() == 0)
         return;
 
     const IPAddress remoteIp = udp.remoteIP();
     const uint16_t remotePort = udp.remotePort();
 
-    char requestPacket[NETWORK_BUFFER_SIZE];
-    char responsePacket[NETWORK_BUFFER_SIZE];
-    char hexPayload[NETWORK_BUFFER_SIZE * 3];
     memset(requestPacket, '\0', NETWORK_BUFFER_SIZE);
-    memset(responsePacket, '\0', NETWORK_BUFFER_SIZE);
-    memset(hexPayload, '\0', NETWORK_BUFFER_SIZE);
 
     const int requestSize = udp.read(requestPacket, NETWORK_BUFFER_SIZE);
     if (requestSize == 0)
         return;
 
+#ifdef TRACE_ENABLED
+    trace->recordDatagram(remoteIp, remotePort, requestPacket, requestSize);
+#endif
+
     printRXDebug(requestPacket, requestSize, remoteIp, remotePort);
 
-    size_t responseSize = 1;
-    responsePacket[0] = requestPacket[0];
+    udp.beginResponse(remoteIp, remotePort);
 
-    switch (requestPacket[0]) {
-        case PROTOCOL_PING:
-            {
-                serialDebugln("Command PING");
+    size_t headerSize = 0;
+    if (requestPacket[0] == PROTOCOL_HEADER) {
+        headerSize = PROTOCOL_HEADER_SIZE;
+        udp.writeValue(requestPacket[0]);
+        udp.writeValue(static_cast<char>(PROTOCOL_VERSION));
+        udp.writeBytes(requestPacket + 2, PROTOCOL_HEADER_SIZE - 2);
+    }
+
+    // A truncated header or an unknown version is answered with a NACK of the header marker itself
+    const bool headerValid = headerSize == 0
+                             || (requestSize > PROTOCOL_HEADER_SIZE && requestPacket[1] == PROTOCOL_VERSION);
 
-                // responseSize += 4;
+    const char* request = headerValid ? requestPacket + headerSize : requestPacket;
 
-                // const DateTime dateTime = RTClib::now();
-                // uint32_t unixtime = dateTime.unixtime();
+    udp.writeValue(request[0]);
 
-                // swapEndian(unixtime);
-                // memcpy(responsePacket + 1, &unixtime, sizeof(uint32_t));
+    benchmarkCommand(request[0]);
+
+    switch (request[0]) {
+        case PROTOCOL_PING:
+            {
+                serialDebuglnF("Command PING");
+
+                udp.writeValue(timeBase->getTime());
             }
             break;
 
         case PROTOCOL_RESET:
             {
-                serialDebugln("Command RESET");
+                serialDebuglnF("Command RESET");
                 executeReset = true;
             }
             break;
 
         case PROTOCOL_TELEMETRY:
             {
-                serialDebugln("Command TELEMETRY");
-
-                // const DateTime dateTime = RTClib::now();
-                // uint32_t unixtime = dateTime.unixtime();
-                // swapEndian(unixtime);
-                // memcpy(responsePacket + 1, &unixtime, sizeof(uint32_t));
-
-                float tempPanelVoltage = panelVoltage;
-                swapEndian(tempPanelVoltage);
-                memcpy(responsePacket + responseSize, &tempPanelVoltage, sizeof(float));
-                responseSize += 4;
-
-                float tempPanelCurrent = panelCurrent;
-                swapEndian(tempPanelCurrent);
-                memcpy(responsePacket + responseSize, &tempPanelCurrent, sizeof(float));
-                responseSize += 4;
-
-                float tempBatteryVoltage = batteryVoltage;
-                swapEndian(tempBatteryVoltage);
-                memcpy(responsePacket + responseSize, &tempBatteryVoltage, sizeof(float));
-                responseSize += 4;
-
-                float tempBatteryChargeCurrent = batteryChargeCurrent;
-                swapEndian(tempBatteryChargeCurrent);
-                memcpy(responsePacket + responseSize, &tempBatteryChargeCurrent, sizeof(float));
-                responseSize += 4;
-
-                responsePacket[responseSize] = globalStatus ? 0x01 : 0x00;
-                responseSize += 1;
+                serialDebuglnF("Command TELEMETRY");
+
+                if (!telemetryCache.isValid())
+                    buildTelemetryCache();
+                telemetryCache.writeTo(udp);
             }
             break;
 
         case PROTOCOL_STATUS:
             {
-                serialDebugln("Command STATUS");
+                serialDebuglnF("Command STATUS");
 
-                *(responsePacket + responseSize) = statusWrongVoltageIdentification ? 0x01 : 0x00;
-                responseSize += 1;
+                if (!statusCache.isValid())
+                    buildStatusCache();
+                statusCache.writeTo(udp);
+            }
+            break;
+
+#ifdef METEO_ENABLED
+        case PROTOCOL_METEO:
+            {
+                serialDebuglnF("Command METEO");
+
+                if (!meteoCache.isValid())
+                    buildMeteoCache();
+                meteoCache.writeTo(udp);
+            }
+            break;
+#endif
 
-                *(responsePacket + responseSize) = static_cast<char>(statusTemperature);
-                responseSize += 1;
+        case PROTOCOL_TIME_SYNC:
+            {
+                serialDebuglnF("Command TIME_SYNC");
+
+                const uint64_t receivedAt = timeBase->getUptime();
+
+                // The offset the client measured on the previous exchange, zero when it has nothing to correct
+                uint64_t clientTime = 0;
+                int64_t offset = 0;
+                const size_t payloadSize = requestSize - headerSize - 1;
+                if (payloadSize >= PROTOCOL_TIME_SYNC_REQUEST_SIZE) {
+                    memcpy(&clientTime, request + 1, sizeof(uint64_t));
+                    swapEndian(clientTime);
+                    memcpy(&offset, request + 9, sizeof(int64_t));
+                    swapEndian(offset);
+                }
 
-                *(responsePacket + responseSize) = static_cast<char>(statusBattery);
-                responseSize += 1;
+                if (offset != 0 && timeBase->correct(offset, receivedAt)) {
+                    telemetryCache.invalidate();
+#ifdef METEO_ENABLED
+                    meteoCache.invalidate();
+#endif
+                }
 
-                *(responsePacket + responseSize) = static_cast<char>(statusCharging);
-                responseSize += 1;
+                udp.writeValue(clientTime);
+                udp.writeValue(timeBase->toTime(receivedAt));
+                udp.writeValue(static_cast<uint8_t>(timeBase->isSynced() ? 0x01 : 0x00));
+                udp.writeValue(timeBase->getDrift());
+                udp.writeValue(timeBase->getTime());
+            }
+            break;
 
-                *(responsePacket + responseSize) = static_cast<char>(statusArrays);
-                responseSize += 1;
+#ifdef EPEVER_DETAILS_ENABLED
+        case PROTOCOL_CONTROLLER_READ:
+            {
+                serialDebuglnF("Command CONTROLLER_READ");
 
-                *(responsePacket + responseSize) = static_cast<char>(statusLoad);
-                responseSize += 1;
+                epever.serializeDetails(udp);
             }
             break;
 
-        case PROTOCOL_METEO:
+        case PROTOCOL_ENERGY_READ:
             {
-                serialDebugln("Command METEO");
+                serialDebuglnF("Command ENERGY_READ");
 
-                float tempBmpPressure = bmpPressure;
-                swapEndian(tempBmpPressure);
-                memcpy(responsePacket + responseSize, &tempBmpPressure, sizeof(float));
-                responseSize += 4;
+                epever.serializeEnergy(udp);
+            }
+            break;
+#endif
+
+#ifdef SENSORS_ENABLED
+        case PROTOCOL_SENSORS_READ:
+            {
+                serialDebuglnF("Command SENSORS_READ");
 
-                float tempBmpTemp = bmpTemp;
-                swapEndian(tempBmpTemp);
-                memcpy(responsePacket + responseSize, &tempBmpTemp, sizeof(float));
-                responseSize += 4;
+                sensors->serialize(udp);
             }
             break;
+#endif
 
 #ifdef RTC_DS3231_ENABLED
         case PROTOCOL_RTC_READ:
             {
-                const DateTime dateTime = RTClib::now();
-                uint32_t unixtime = dateTime.unixtime();
-                swapEndian(unixtime);
-                memcpy(responsePacket + responseSize, &unixtime, sizeof(uint32_t));
-                responseSize += sizeof(uint32_t);
+                udp.writeValue(rtc.getUnixtime());
             }
             break;
 
         case PROTOCOL_RTC_SET:
             {
-                time_t newUnixtime;
-                memcpy(&newUnixtime, requestPacket + 1, sizeof(time_t));
+                uint32_t newUnixtime;
+                memcpy(&newUnixtime, request + 1, sizeof(uint32_t));
                 swapEndian(newUnixtime);
-                rtc.setEpoch(newUnixtime);
+                rtc.setUnixtime(newUnixtime);
 
-                const DateTime dateTime = RTClib::now();
-                uint32_t unixtime = dateTime.unixtime();
-                swapEndian(unixtime);
-                memcpy(responsePacket + responseSize, &unixtime, sizeof(uint32_t));
-                responseSize += sizeof(uint32_t);
+                udp.writeValue(rtc.getUnixtime());
             }
             break;
 #endif
 
         case PROTOCOL_CONFIG_READ:
             {
-                serialDebugln("Command CONFIG_READ");
-
-                responsePacket[1] = requestPacket[1];
-                responseSize += 1;
-
-                switch (requestPacket[1]) {
-                    case CONFIG_MAIN_VOLTAGE_OFF_PARAM:
-                        {
-                            float mainVoltageOff = config.getMainVoltageOff();
-                            swapEndian(mainVoltageOff);
-                            memcpy(responsePacket + responseSize, &mainVoltageOff, sizeof(float));
-                            responseSize += sizeof(float);
-                        }
-                        break;
+                serialDebuglnF("Command CONFIG_READ");
 
-                    case CONFIG_MAIN_VOLTAGE_ON_PARAM:
-                        {
-                            float mainVoltageOn = config.getMainVoltageOn();
-                            swapEndian(mainVoltageOn);
-                            memcpy(responsePacket + responseSize, &mainVoltageOn, sizeof(float));
-                            responseSize += sizeof(float);
-                        }
-                        break;
+                udp.writeValue(request[1]);
 
-                    default:
-                        break;
+                const uint8_t index = Config::indexOf(request[1]);
+                if (index != CONFIG_PARAM_UNKNOWN) {
+                    char value[CONFIG_VALUE_MAX_SIZE];
+                    udp.writeBytes(value, config.serialize(index, value));
                 }
             }
             break;
 
         case PROTOCOL_CONFIG_SET:
             {
-                serialDebugln("Command CONFIG_SET");
-
-                responsePacket[1] = requestPacket[1];
-                responseSize += 1;
-
-                switch (requestPacket[1]) {
-                    case CONFIG_MAIN_VOLTAGE_OFF_PARAM:
-                        {
-                            float value;
-                            memcpy(&value, requestPacket + 2, sizeof(float));
-                            swapEndian(value);
-                            serialDebug("New Main Voltage OFF: ");
-                            serialDebugln(value);
-                            config.setMainVoltageOff(value);
-
-                            float mainVoltageOff = config.getMainVoltageOff();
-                            swapEndian(mainVoltageOff);
-                            memcpy(responsePacket + responseSize, &mainVoltageOff, sizeof(float));
-                            responseSize += sizeof(float);
-                        }
-                        break;
+                serialDebuglnF("Command CONFIG_SET");
+
+                // A truncated value would be completed with whatever an earlier request left in the buffer
+                const uint8_t index = Config::indexOf(request[1]);
+                const int valueSize = requestSize - static_cast<int>(headerSize) - 2;
+                if (index != CONFIG_PARAM_UNKNOWN && valueSize < Config::getValueSize(index)) {
+                    writeNack(request[0], headerSize);
+                    break;
+                }
+
+                udp.writeValue(request[1]);
+
+                if (index != CONFIG_PARAM_UNKNOWN) {
+                    if (config.deserialize(index, request + 2)) {
+                        config.commit();
+                        applyConfig();
+                        events->publish(EventCode::Config, request[1], 0x00);
+                    }
+
+                    char value[CONFIG_VALUE_MAX_SIZE];
+                    udp.writeBytes(value, config.serialize(index, value));
+                }
+            }
+            break;
+
+        case PROTOCOL_CONFIG_READ_ALL:
+            {
+                serialDebuglnF("Command CONFIG_READ_ALL");
+
+                config.serializeAll(udp);
+            }
+            break;
+
+        case PROTOCOL_CONFIG_SET_ALL:
+            {
+                serialDebuglnF("Command CONFIG_SET_ALL");
+
+                const size_t payloadSize = requestSize - headerSize - 1;
+                const uint8_t applied = config.deserializeAll(request + 1, payloadSize);
+                if (applied > 0) {
+                    config.commit();
+                    applyConfig();
+                    events->publish(EventCode::Config, PROTOCOL_CONFIG_SET_ALL, applied);
+                }
+
+                udp.writeValue(applied);
+                config.serializeAll(udp);
+            }
+            break;
+
+#ifdef STATISTICS_ENABLED
+        case PROTOCOL_STATS_READ:
+        case PROTOCOL_STATS_RESET:
+            {
+                if (request[0] == PROTOCOL_STATS_RESET) {
+                    serialDebuglnF("Command STATS_RESET");
+                } else {
+                    serialDebuglnF("Command STATS_READ");
+                }
+
+                const unsigned long now = millis();
+
+                udp.writeValue(statistics.getEpoch());
+                udp.writeValue(statistics.getDuration(now));
+                udp.writeValue(statistics.getSamples());
+                udp.writeValue(statistics.getBatteryVoltageMin());
+                udp.writeValue(statistics.getBatteryVoltageMax());
+                udp.writeValue(statistics.getBatteryVoltageMean());
+                udp.writeValue(statistics.getPanelPowerMin());
+                udp.writeValue(statistics.getPanelPowerMax());
+                udp.writeValue(statistics.getPanelPowerMean());
+                udp.writeValue(statistics.getEnergyHarvested());
+                udp.writeValue(statistics.getChargeAccumulated());
+
+                // The closed epoch is returned before rolling over, so no sample is lost between read and reset
+                if (request[0] == PROTOCOL_STATS_RESET)
+                    statistics.reset(now);
+            }
+            break;
+#endif
+
+#ifdef DIAGNOSTICS_ENABLED
+        case PROTOCOL_DIAGNOSTICS:
+            {
+                serialDebuglnF("Command DIAGNOSTICS");
+
+                const uint32_t uptime = millis() / 1000UL;
+                udp.writeValue(uptime);
+                udp.writeValue(diagnostics.getResetCause());
+                udp.writeValue(diagnostics.getRamSize());
+                udp.writeValue(diagnostics.getStaticRam());
+                udp.writeValue(diagnostics.getStackHighWaterMark());
+                udp.writeValue(diagnostics.getStackUnused());
+                udp.writeValue(diagnostics.getHeapFree());
+                udp.writeValue(diagnostics.getHeapLargestFreeBlock());
+                udp.writeValue(udp.getFailedSends());
+    #ifdef I2C_ENABLED
+                udp.writeValue(i2c->getTimeouts());
+                udp.writeValue(i2c->getRecoveries());
+    #else
+                udp.writeValue(static_cast<uint16_t>(0));
+                udp.writeValue(static_cast<uint16_t>(0));
+    #endif
+            }
+            break;
+#endif
+
+        case PROTOCOL_EVENT_SUBSCRIBE:
+            {
+                serialDebuglnF("Command EVENT_SUBSCRIBE");
+
+                udp.writeValue(events->subscribe(remoteIp, remotePort));
+                udp.writeValue(events->getLastSequence());
+            }
+            break;
+
+        case PROTOCOL_EVENT_UNSUBSCRIBE:
+            {
+                serialDebuglnF("Command EVENT_UNSUBSCRIBE");
+
+                events->unsubscribe(remoteIp, remotePort);
+            }
+            break;
+
+        case PROTOCOL_EVENT_ACK:
+            {
+                serialDebuglnF("Command EVENT_ACK");
+
+                uint16_t sequence;
+                memcpy(&sequence, request + 1, sizeof(uint16_t));
+                swapEndian(sequence);
+                events->acknowledge(remoteIp, remotePort, sequence);
+
+                udp.writeValue(sequence);
+            }
+            break;
+
+        case PROTOCOL_LOG_READ:
+            {
+                serialDebuglnF("Command LOG_READ");
+
+                uint16_t page;
+                memcpy(&page, request + 1, sizeof(uint16_t));
+                swapEndian(page);
 
-                    case CONFIG_MAIN_VOLTAGE_ON_PARAM:
-                        {
-                            float value;
-                            memcpy(&value, requestPacket + 2, sizeof(float));
-                            swapEndian(value);
-                            serialDebug("New Main Voltage ON: ");
-                            serialDebugln(value);
-                            config.setMainVoltageOn(value);
-
-                            float mainVoltageOn = config.getMainVoltageOn();
-                            swapEndian(mainVoltageOn);
-                            memcpy(responsePacket + responseSize, &mainVoltageOn, sizeof(float));
-                            responseSize += sizeof(float);
-                        }
+                eventLog->serializePage(page, udp);
+            }
+            break;
+
+#ifdef SD_LOGGER_ENABLED
+        case PROTOCOL_SD_READ:
+            {
+                serialDebuglnF("Command SD_READ");
+
+                uint16_t day;
+                memcpy(&day, request + 1, sizeof(uint16_t));
+                swapEndian(day);
+
+                uint32_t offset;
+                memcpy(&offset, request + 3, sizeof(uint32_t));
+                swapEndian(offset);
+
+                udp.writeValue(day);
+                udp.writeValue(offset);
+
+                const size_t chunkSizeAt = udp.getResponseSize();
+                udp.writeValue(static_cast<uint8_t>(0x00));
+
+                // The request is parsed, its buffer carries the file into the response a piece at a time
+                auto* piece = reinterpret_cast<uint8_t*>(requestPacket);
+                int chunkSize = 0;
+                while (chunkSize < SD_LOGGER_CHUNK_SIZE) {
+                    const int remaining = SD_LOGGER_CHUNK_SIZE - chunkSize;
+                    const uint16_t pieceMax = remaining < NETWORK_BUFFER_SIZE ? remaining : NETWORK_BUFFER_SIZE;
+                    const int pieceSize = sdLogger.read(day, offset + chunkSize, piece, pieceMax);
+                    if (pieceSize < 0) {
+                        if (chunkSize == 0)
+                            chunkSize = -1;
                         break;
+                    }
 
-                    default:
+                    udp.writeBytes(piece, pieceSize);
+                    chunkSize += pieceSize;
+                    if (pieceSize < pieceMax)
                         break;
                 }
+
+                // 0xFF flags a missing card or file, 0 the end of the file
+                udp.patchValue(chunkSizeAt, static_cast<uint8_t>(chunkSize < 0 ? 0xFF : chunkSize));
             }
             break;
+#endif
 
+#ifdef RELAIS_ENABLED
         case PROTOCOL_OUTPUT_READ:
             {
-                serialDebugln("Command OUTPUT_READ");
+                serialDebuglnF("Command OUTPUT_READ");
+
+                const uint8_t outputNumber = request[1];
+                if (outputNumber >= RELAIS_NUMBER) {
+                    writeNack(request[0], headerSize);
+                    break;
+                }
 
-                const uint8_t outputNumber = requestPacket[1];
-                responsePacket[1] = outputNumber;
-                responsePacket[2] = relais->getStatus(outputNumber) ? 0x01 : 0x00;
-                responseSize += 2;
+                udp.writeValue(outputNumber);
+                udp.writeValue(static_cast<uint8_t>(relais->getStatus(outputNumber) ? 0x01 : 0x00));
             }
             break;
 
         case PROTOCOL_OUTPUT_SET:
             {
-                serialDebugln("Command OUTPUT_SET");
+                serialDebuglnF("Command OUTPUT_SET");
+
+                const uint8_t outputNumber = request[1];
+                if (outputNumber >= RELAIS_NUMBER) {
+                    writeNack(request[0], headerSize);
+                    break;
+                }
 
-                const uint8_t outputNumber = requestPacket[1];
-                const bool newStatus = requestPacket[2] > 0;
+                const bool newStatus = request[2] > 0;
 
                 relais->setStatus(outputNumber, newStatus);
 
-                responsePacket[1] = outputNumber;
-                responsePacket[2] = relais->getStatus(outputNumber) ? 0x01 : 0x00;
-                responseSize += 2;
+                // A switch by hand goes to the relais at once, the thresholds are judged again once they settle
+                applyRelais();
+                executeEvaluation = true;
+
+                udp.writeValue(outputNumber);
+                udp.writeValue(static_cast<uint8_t>(relais->getStatus(outputNumber) ? 0x01 : 0x00));
+            }
+            break;
+
+        case PROTOCOL_LOADS_READ:
+            {
+                serialDebuglnF("Command LOADS_READ");
+
+                shedder.serialize(udp);
             }
             break;
 
+        case PROTOCOL_LOADS_SET:
+            {
+                serialDebuglnF("Command LOADS_SET");
+
+                const size_t payloadSize = requestSize - headerSize - 1;
+                const bool applied = shedder.deserialize(request + 1, payloadSize);
+                if (applied) {
+                    executeEvaluation = true;
+                    events->publish(EventCode::Config, PROTOCOL_LOADS_SET, request[1]);
+                }
+
+                udp.writeValue(static_cast<uint8_t>(applied ? 0x01 : 0x00));
+                shedder.serialize(udp);
+            }
+            break;
+#endif
+
         default:
             {
-                serialDebugln("Command not recognized!!! Sending NACK!!!");
+                serialDebuglnF("Command not recognized!!! Sending NACK!!!");
 
-                responsePacket[0] = PROTOCOL_NACK;
-                responsePacket[1] = requestPacket[0];
-                responseSize += 2;
+                writeNack(request[0], headerSize);
             }
     }
 
-    printTXDebug(responsePacket, responseSize, remoteIp, remotePort);
+    udp.endResponse();
 
-    udp.beginPacket(remoteIp, remotePort);
-    udp.write(responsePacket, responseSize);
-    udp.endPacket();
+    printTXDebug(remoteIp, remotePort);
 }
 
-#ifdef SENSOR_BMP280_ENABLED
-void doReadBMP() {
-    bmpTemp = bmp.readTemperature();
-    bmpPressure = bmp.readPressure() / 100.0f;
+void writeNack(const char opcode, const size_t headerSize) {
+    // Drop the echoed opcode, the NACK carries it as its argument
+    udp.truncateResponse(headerSize);
+    udp.writeValue(static_cast<char>(PROTOCOL_NACK));
+    udp.writeValue(opcode);
+    udp.writeValue(static_cast<uint8_t>(0x00));
+}
+
+#ifdef SENSORS_ENABLED
+void doAcquireSensors() {
+    serialDebugHeader("SENSORS");
+    for (uint8_t id = 0; id < sensors->getCount(); id++) {
+        serialDebug(id);
+        serialDebugF(": ");
+        serialDebug(static_cast<uint8_t>(sensors->getStatus(id)));
+        serialDebugF(" [");
+        serialDebug(sensors->getValue(id, 0));
+        serialDebugF(" ");
+        serialDebug(sensors->getValue(id, 1));
+        serialDebugF("] ");
+    }
+    serialDebugln();
 
-    serialDebugHeader("BMP280");
-    serialDebug("Temp: ");
-    serialDebug(bmpTemp);
-    serialDebug(" - Pressure: ");
-    serialDebugln(bmpPressure);
+    // Results land through Sensors::poll() on the following loop passes
+    sensors->acquire();
+}
+#endif
+
+#ifdef RTC_DS3231_ENABLED
+void doReadRTC() {
+    rtc.update();
 }
 #endif
 
 void doReadEpeverData() {
-    const uint8_t result = node.readInputRegisters(0x3100, 6);
+    // Every sample, valid or not, feeds the evaluation pipeline in the same loop pass
+    executeEvaluation = true;
+
+    const uint8_t result = readEpeverBlock(EpeverBlock::RealTime);
+
     if (result != ModbusMaster::ku8MBSuccess) {
         panelVoltage = 0;
         panelCurrent = 0;
         batteryVoltage = 0;
         batteryChargeCurrent = 0;
-        return;
+    } else {
+        panelVoltage = node.getResponseBuffer(0x00) / 100.0f;
+        panelCurrent = node.getResponseBuffer(0x01) / 100.0f;
+        batteryVoltage = node.getResponseBuffer(0x04) / 100.0f;
+        batteryChargeCurrent = node.getResponseBuffer(0x05) / 100.0f;
+
+        // A failed read is no reading at all, the thresholds keep judging the last filtered voltage
+        benchmarkBegin(FilterPush);
+        batteryVoltageFiltered = batteryVoltageFilter.push(batteryVoltage);
+        benchmarkEnd(FilterPush);
     }
 
-    panelVoltage = node.getResponseBuffer(0x00) / 100.0f;
-    panelCurrent = node.getResponseBuffer(0x01) / 100.0f;
-    batteryVoltage = node.getResponseBuffer(0x04) / 100.0f;
-    batteryChargeCurrent = node.getResponseBuffer(0x05) / 100.0f;
+    telemetrySampledAt = timeBase->getUptime();
+
+#if defined(STATISTICS_ENABLED) || defined(SD_LOGGER_ENABLED)
+    if (result == ModbusMaster::ku8MBSuccess) {
+        const unsigned long now = millis();
+
+    #ifdef STATISTICS_ENABLED
+        benchmarkBegin(StatisticsPush);
+        statistics.push(now, batteryVoltage, batteryChargeCurrent, panelVoltage, panelCurrent);
+        benchmarkEnd(StatisticsPush);
+    #endif
+
+    #ifdef SD_LOGGER_ENABLED
+        sdLogger.push(timeBase->toTime(telemetrySampledAt), panelVoltage, panelCurrent, batteryVoltage, batteryChargeCurrent, batteryVoltageFiltered);
+    #endif
+    }
+#endif
+
+    telemetryCache.invalidate();
+}
+
+template <typename T>
+void updateStatus(T& status, const T newValue, const EventCode code) {
+    if (status != newValue)
+        events->publish(code, 0, static_cast<uint8_t>(newValue));
+    status = newValue;
 }
 
 void doReadEpeverStatus() {
-    const uint8_t result = node.readInputRegisters(0x3200, 3);
+    const uint8_t result = readEpeverBlock(EpeverBlock::Status);
     if (result != ModbusMaster::ku8MBSuccess) {
         return;
     }
 
     uint16_t tempBuffer = node.getResponseBuffer(0x00);
-    statusWrongVoltageIdentification = tempBuffer & 0x8000;
+    updateStatus(statusWrongVoltageIdentification, (tempBuffer & 0x8000) != 0, EventCode::WrongVoltageIdentification);
 
     uint8_t tempData = (tempBuffer & 0x00F0) >> 4;    // D7-D4 shifted down
-    statusTemperature = static_cast<Temperature>(tempData);
+    updateStatus(statusTemperature, static_cast<Temperature>(tempData), EventCode::Temperature);
 
     tempData = (tempBuffer & 0x000F);    // D3-D0
-    statusBattery = static_cast<Battery>(tempData);
+    updateStatus(statusBattery, static_cast<Battery>(tempData), EventCode::Battery);
 
     tempBuffer = node.getResponseBuffer(0x01);
 
     tempData = (tempBuffer & 0x000C) >> 2;    // D3-D2 shifted down
-    statusCharging = static_cast<Charging>(tempData);
+    updateStatus(statusCharging, static_cast<Charging>(tempData), EventCode::Charging);
 
     tempData = (tempBuffer & 0xC000) >> 14;    // D15-D14 shifted down
-    statusArrays = static_cast<Arrays>(tempData);
+    updateStatus(statusArrays, static_cast<Arrays>(tempData), EventCode::Arrays);
 
     tempBuffer = node.getResponseBuffer(0x02);
     tempData = (tempBuffer & 0x3000) >> 12;    // D3-12 shifted down
-    statusLoad = static_cast<Load>(tempData);
+    updateStatus(statusLoad, static_cast<Load>(tempData), EventCode::Load);
+
+    statusCache.invalidate();
+}
+
+#ifdef EPEVER_DETAILS_ENABLED
+void doReadEpeverDetails() {
+    // One block per run, every Modbus read blocks the loop for up to the response timeout when the controller is
+    // not answering
+    readEpeverBlock(nextDetailsBlock);
+    nextDetailsBlock = nextDetailsBlock == EpeverBlock::Soc ? EpeverBlock::Battery : EpeverBlock::Soc;
+}
+
+void doReadEpeverEnergy() {
+    readEpeverBlock(EpeverBlock::Energy);
+}
+#endif
+
+uint8_t readEpeverBlock(const EpeverBlock block) {
+    const uint8_t result = epever.read(block);
+
+#ifdef TRACE_ENABLED
+    traceModbus(Epever::getAddress(block), result, Epever::getCount(block));
+#endif
+
+    return result;
 }
 
 void doEvaluateGlobalStatus() {
     const float& onVoltage = config.getMainVoltageOn();
     const float& offVoltage = config.getMainVoltageOff();
+    const unsigned long holdTime = config.getFilterHoldTime() * 1000UL;
+    const bool previousGlobalStatus = globalStatus;
+
+    if (batteryVoltageFiltered >= onVoltage) {
+        globalStatus = true;
+        batteryVoltageLowSince = 0;
+    } else if (globalStatus && batteryVoltageFiltered <= offVoltage) {
+        const unsigned long now = millis();
+        if (batteryVoltageLowSince == 0)
+            batteryVoltageLowSince = now;
+        if (now - batteryVoltageLowSince >= holdTime) {
+            globalStatus = false;
+            batteryVoltageLowSince = 0;
+        }
+    } else {
+        batteryVoltageLowSince = 0;
+    }
+
+    if (globalStatus != previousGlobalStatus)
+        events->publish(EventCode::GlobalStatus, 0, globalStatus ? 0x01 : 0x00);
 
-    globalStatus = batteryVoltage >= onVoltage || (globalStatus && !(batteryVoltage <= offVoltage));
+    telemetryCache.invalidate();
 
     serialDebugHeader("STATUS");
-    serialDebug("BV: ");
+    serialDebugF("BV: ");
     serialDebug(batteryVoltage);
-    serialDebug(" - on: ");
+    serialDebugF(" - filtered: ");
+    serialDebug(batteryVoltageFiltered);
+    serialDebugF(" - on: ");
     serialDebug(onVoltage);
-    serialDebug(" - off: ");
+    serialDebugF(" - off: ");
     serialDebug(offVoltage);
-    serialDebug(" - GS: ");
+    serialDebugF(" - GS: ");
     serialDebugln(globalStatus);
 }
 
+#ifdef RELAIS_ENABLED
 void doEvaluateRelais() {
+    benchmarkBegin(LoadShedding);
+    shedder.evaluate(batteryVoltageFiltered, relais->getEnabled(), millis());
+    benchmarkEnd(LoadShedding);
+
+    applyRelais();
+}
+
+void applyRelais() {
+    const uint8_t enabled = relais->getEnabled();
+
+    // The global status stays the last resort, it drops whatever load shedding left on
+    const uint8_t outputs = globalStatus ? enabled & shedder.getPowered() : 0x00;
+
+    switcher.setTarget(outputs);
+
     serialDebugHeader("RELAIS");
-    for (int i = 0; i < RELAIS_NUMBER; i++) {
-        serialDebug(relais->getStatus(i) ? "1" : "0");
-        digitalWrite(relaisPins[i], globalStatus && relais->getStatus(i) ? LOW : HIGH);
-    }
+    for (int i = 0; i < RELAIS_NUMBER; i++)
+        serialDebug((outputs & (1 << i)) != 0 ? '1' : (enabled & (1 << i)) != 0 ? 's' : '0');
     serialDebugln();
 }
+#endif
+
+void doSendBeacon() {
+    if (config.getBeaconPeriod() == 0)
+        return;
+
+    if (!telemetryCache.isValid())
+        buildTelemetryCache();
+    if (!statusCache.isValid())
+        buildStatusCache();
+
+    const IPAddress beaconIp(config.getBeaconAddress());
+
+    // A busy socket skips this beacon, the next period sends a fresh one
+    if (!udp.beginResponse(beaconIp, NETWORK_BEACON_PORT))
+        return;
+
+    udp.writeValue(static_cast<char>(PROTOCOL_BEACON));
+    telemetryCache.writeTo(udp);
+    statusCache.writeTo(udp);
+    udp.endResponse();
+
+    printTXDebug(beaconIp, NETWORK_BEACON_PORT);
+}
+
+void doSendEvents() {
+    if (udp.isSending())
+        return;
+
+    const unsigned long now = millis();
+
+    EventReceiver* receiver = events->nextPendingReceiver(now);
+    if (receiver == nullptr)
+        return;
+
+    udp.beginResponse(receiver->ip, receiver->port);
+    udp.writeValue(static_cast<char>(PROTOCOL_EVENT));
+    events->serialize(receiver, udp, now);
+    udp.endResponse();
+
+    printTXDebug(receiver->ip, receiver->port);
+}
+
+void doFlushEventLog() {
+    eventLog->flush();
+}
+
+#ifdef SD_LOGGER_ENABLED
+void doFlushSdLog() {
+    sdLogger.flush();
+}
+#endif
+
+#ifdef TRACE_TO_SD
+void doFlushTrace() {
+    trace->flush();
+}
+#endif
+
+#ifdef TRACE_ENABLED
+void traceModbus(const uint16_t address, const uint8_t result, const uint8_t count) {
+    uint16_t registers[TRACE_MODBUS_MAX_REGISTERS];
+    for (uint8_t i = 0; i < count; i++)
+        registers[i] = result == ModbusMaster::ku8MBSuccess ? node.getResponseBuffer(i) : 0;
+
+    trace->recordModbus(address, result, registers, count);
+}
+
+    #ifdef SENSORS_ENABLED
+void traceSensors(const uint8_t updated) {
+    for (uint8_t id = 0; id < sensors->getCount(); id++) {
+        if ((updated & (1 << id)) == 0)
+            continue;
+
+        SensorQuantity quantities[SENSORS_MAX_CHANNELS];
+        float values[SENSORS_MAX_CHANNELS];
+        const uint8_t channels = sensors->getChannelCount(id);
+        for (uint8_t channel = 0; channel < channels; channel++) {
+            quantities[channel] = sensors->getQuantity(id, channel);
+            values[channel] = sensors->getValue(id, channel);
+        }
+
+        trace->recordSensor(id, sensors->getType(id), channels, quantities, values);
+    }
+}
+    #endif
+#endif
+
+void buildTelemetryCache() {
+    char* buffer = telemetryCache.getBuffer();
+
+    buffer += packValue(buffer, timeBase->toTime(telemetrySampledAt));
+    buffer += packValue(buffer, panelVoltage);
+    buffer += packValue(buffer, panelCurrent);
+    buffer += packValue(buffer, batteryVoltage);
+    buffer += packValue(buffer, batteryChargeCurrent);
+    buffer += packValue(buffer, static_cast<uint8_t>(globalStatus ? 0x01 : 0x00));
+    packValue(buffer, batteryVoltageFiltered);
+
+    telemetryCache.validate();
+}
+
+void buildStatusCache() {
+    char* buffer = statusCache.getBuffer();
+
+    buffer += packValue(buffer, static_cast<uint8_t>(statusWrongVoltageIdentification ? 0x01 : 0x00));
+    buffer += packValue(buffer, statusTemperature);
+    buffer += packValue(buffer, statusBattery);
+    buffer += packValue(buffer, statusCharging);
+    buffer += packValue(buffer, statusArrays);
+    packValue(buffer, statusLoad);
+
+    statusCache.validate();
+}
+
+#ifdef METEO_ENABLED
+void buildMeteoCache() {
+    char* buffer = meteoCache.getBuffer();
+
+    buffer += packValue(buffer, timeBase->toTime(meteoSampledAt));
+    // Temperature and pressure of the first BMP280, zero when it is not fitted
+    buffer += packValue(buffer, sensors->getValue(meteoSensor, 1));
+    packValue(buffer, sensors->getValue(meteoSensor, 0));
+
+    meteoCache.validate();
+}
+#endif
 
+void applyConfig() {
+    batteryVoltageFilter.setEmaAlpha(config.getFilterEmaAlpha());
+    batteryVoltageFilter.setMedianSize(config.getFilterMedianSize());
+#ifdef RELAIS_ENABLED
+    shedder.setDwellTimes(config.getLoadMinOnTime(), config.getLoadMinOffTime());
+#endif
+    executeEvaluation = true;
+}
+
+#ifdef DIAGNOSTICS_ENABLED
+void doScanMemory() {
+    diagnostics.scan();
+
+    serialDebugHeader("MEMORY");
+    serialDebugF("Stack HWM: ");
+    serialDebug(diagnostics.getStackHighWaterMark());
+    serialDebugF(" - unused: ");
+    serialDebug(diagnostics.getStackUnused());
+    serialDebugF(" - heap free: ");
+    serialDebug(diagnostics.getHeapFree());
+    serialDebugF(" - largest block: ");
+    serialDebugln(diagnostics.getHeapLargestFreeBlock());
+}
+#endif
+
+#ifdef RELAIS_ENABLED
 void rainbow() {
     for (const int pin : relaisPins) {
         digitalWrite(pin, LOW);
@@ -552,6 +1250,7 @@ void rainbow() {
         delayRainbow();
     }
 }
+#endif
 
 void modbusPreTransmission() {
     digitalWrite(PIN_EPEVER_RE, HIGH);
@@ -568,37 +1267,49 @@ void printNetworkDebug(
     const bool isTx,
     const char* payload,
     const size_t payloadSize,
+    const size_t totalSize,
     const IPAddress& remoteIp,
     const uint16_t remotePort) {
-    char hexPayload[NETWORK_BUFFER_SIZE * 3];
-    memset(hexPayload, '\0', NETWORK_BUFFER_SIZE);
-    payloadToHex(hexPayload, payload, payloadSize);
-
     serialDebugHeader("NET");
 
     if (isTx)
-        serialDebug(" TX \"");
+        serialDebugF(" TX \"");
     else
-        serialDebug(" RX \"");
+        serialDebugF(" RX \"");
 
     serialDebug(payload[0]);
 
     if (isTx)
-        serialDebug("\" response of ");
+        serialDebugF("\" response of ");
     else
-        serialDebug("\" request of ");
-
-    serialDebug(payloadSize);
-    serialDebug(" bytes [");
-    serialDebug(hexPayload);
+        serialDebugF("\" request of ");
+
+    serialDebug(totalSize);
+    serialDebugF(" bytes [");
+    for (size_t i = 0; i < payloadSize; i++) {
+        if (i > 0)
+            serialDebug(' ');
+        const auto value = static_cast<uint8_t>(payload[i]);
+        if (value < 0x10)
+            serialDebug('0');
+        serialDebugHex(value);
+    }
+    if (payloadSize < totalSize)
+        serialDebugF(" ...");
 
     if (isTx)
-        serialDebug("] to ");
+        serialDebugF("] to ");
     else
-        serialDebug("] from ");
+        serialDebugF("] from ");
 
     serialDebug(remoteIp);
-    serialDebug(":");
+    serialDebugF(":");
     serialDebugln(remotePort);
 }
-#endif
\ No newline at end of file
+
+void printResponseDebug(const IPAddress& remoteIp, const uint16_t remotePort) {
+    // The response only lives in the W5100 buffer, the request buffer is free again to read it back
+    const size_t payloadSize = udp.readResponse(requestPacket, NETWORK_BUFFER_SIZE);
+    printNetworkDebug(true, requestPacket, payloadSize, udp.getResponseSize(), remoteIp, remotePort);
+}
+#endif
@@ -25,7 +25,9 @@
 #include <IPAddress.h>
 #include <stddef.h>
 
+#include "benchmark.hpp"
 #include "const.hpp"
+#include "epever.hpp"
 
 #define declareLastExecution(x) unsigned long lastExecution##x = 0
 
@@ -36,8 +38,10 @@
         lastExecution##jobName = 0; \
     if (clockNow - lastExecution##jobName > timeSpan) { \
         lastExecution##jobName = clockNow; \
+        benchmarkBegin(jobName); \
         do \
             ##jobName(); \
+        benchmarkEnd(jobName); \
     };
 
 #ifdef DEBUG
@@ -45,50 +49,113 @@
     #define serialDebugln(x) \
         Serial.println(x); \
         Serial.flush()
+    #define serialDebugF(x) Serial.print(F(x))
+    #define serialDebuglnF(x) \
+        Serial.println(F(x)); \
+        Serial.flush()
+    #define serialDebugHex(x) Serial.print(x, HEX)
 #else
     #define serialDebug(x)
     #define serialDebugln(x)
+    #define serialDebugF(x)
+    #define serialDebuglnF(x)
+    #define serialDebugHex(x)
 #endif
 
 #define swapEndian(x) swapEndianness(&x, sizeof(x));
 
 #define delayRainbow() delay(RAINBOW_DELAY)
 
-#define printTXDebug(payload, payloadSize, remoteIp, remotePort) \
-    printNetworkDebug(true, payload, payloadSize, remoteIp, remotePort)
+#define printTXDebug(remoteIp, remotePort) printResponseDebug(remoteIp, remotePort)
 #define printRXDebug(payload, payloadSize, remoteIp, remotePort) \
-    printNetworkDebug(false, payload, payloadSize, remoteIp, remotePort)
+    printNetworkDebug(false, payload, payloadSize, payloadSize, remoteIp, remotePort)
 
 /*
 #define serialDebugHeader(x) \
-    serialDebug(RTClib::now().unixtime()); \
+    serialDebug(rtc.getUnixtime()); \
     serialDebug(" ["); \
     serialDebug(x); \
     serialDebug("] ");
 */
 
 #define serialDebugHeader(x) \
-    serialDebug("["); \
-    serialDebug(x); \
-    serialDebug("] ");
+    serialDebug('['); \
+    serialDebugF(x); \
+    serialDebugF("] ");
 
 void (*resetFunc)() = nullptr;
 
 void doReceiveCommand();
 
-#ifdef SENSOR_BMP280_ENABLED
-void doReadBMP();
+void writeNack(char opcode, size_t headerSize);
+
+#ifdef SENSORS_ENABLED
+void doAcquireSensors();
+#endif
+
+#ifdef RTC_DS3231_ENABLED
+void doReadRTC();
 #endif
 
 void doReadEpeverData();
 
 void doReadEpeverStatus();
 
+#ifdef EPEVER_DETAILS_ENABLED
+void doReadEpeverDetails();
+
+void doReadEpeverEnergy();
+#endif
+
+uint8_t readEpeverBlock(EpeverBlock block);
+
 void doEvaluateGlobalStatus();
 
+#ifdef RELAIS_ENABLED
 void doEvaluateRelais();
 
+void applyRelais();
+#endif
+
+void applyConfig();
+
+#ifdef DIAGNOSTICS_ENABLED
+void doScanMemory();
+#endif
+
+void doSendBeacon();
+
+void doSendEvents();
+
+void doFlushEventLog();
+
+#ifdef SD_LOGGER_ENABLED
+void doFlushSdLog();
+#endif
+
+#ifdef TRACE_TO_SD
+void doFlushTrace();
+#endif
+
+#ifdef TRACE_ENABLED
+void traceModbus(uint16_t address, uint8_t result, uint8_t count);
+
+    #ifdef SENSORS_ENABLED
+void traceSensors(uint8_t updated);
+    #endif
+#endif
+
+void buildTelemetryCache();
+
+void buildStatusCache();
+
+#ifdef METEO_ENABLED
+void buildMeteoCache();
+#endif
+
+#ifdef RELAIS_ENABLED
 void rainbow();
+#endif
 
 void modbusPreTransmission();
 
@@ -96,9 +163,17 @@ void modbusPostTransmission();
 
 #ifdef DEBUG
 void printNetworkDebug(
-    bool isTx, const char* payload, size_t payloadSize, const IPAddress& remoteIp, uint16_t remotePort);
+    bool isTx,
+    const char* payload,
+    size_t payloadSize,
+    size_t totalSize,
+    const IPAddress& remoteIp,
+    uint16_t remotePort);
+
+void printResponseDebug(const IPAddress& remoteIp, uint16_t remotePort);
 #else
-    #define printNetworkDebug(isTx, payload, payloadSize, remoteIp, remotePort)
+    #define printNetworkDebug(isTx, payload, payloadSize, totalSize, remoteIp, remotePort)
+    #define printResponseDebug(remoteIp, remotePort)
 #endif
 
 #endif
@@ -0,0 +1,162 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "network.hpp"
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <utility/w5100.h>
+
+StreamingUDP::StreamingUDP() {
+    sending = false;
+    sendStart = 0;
+    failedSends = 0;
+    txStart = 0;
+    txFree = 0;
+    txSize = 0;
+}
+
+StreamingUDP::~StreamingUDP() = default;
+
+bool StreamingUDP::isSending() {
+    if (!sending)
+        return false;
+
+    SPI.beginTransaction(SPI_ETHERNET_SETTINGS);
+    const uint8_t interrupts = W5100.readSnIR(sockindex);
+    if (interrupts & (SnIR::SEND_OK | SnIR::TIMEOUT)) {
+        W5100.writeSnIR(sockindex, SnIR::SEND_OK | SnIR::TIMEOUT);
+        sending = false;
+        if (interrupts & SnIR::TIMEOUT)
+            failedSends++;
+    }
+    SPI.endTransaction();
+
+    if (sending && millis() - sendStart > NETWORK_SEND_TIMEOUT) {
+        sending = false;
+        failedSends++;
+    }
+
+    return sending;
+}
+
+bool StreamingUDP::beginResponse(const IPAddress& ip, const uint16_t port) {
+    if (isSending())
+        return false;
+
+    uint8_t address[4] = {ip[0], ip[1], ip[2], ip[3]};
+
+    SPI.beginTransaction(SPI_ETHERNET_SETTINGS);
+    W5100.writeSnDIPR(sockindex, address);
+    W5100.writeSnDPORT(sockindex, port);
+    txStart = W5100.readSnTX_WR(sockindex);
+
+    // The free size register is not latched, two equal reads make a consistent value
+    uint16_t previousFree;
+    txFree = W5100.readSnTX_FSR(sockindex);
+    do {
+        previousFree = txFree;
+        txFree = W5100.readSnTX_FSR(sockindex);
+    } while (txFree != previousFree);
+    SPI.endTransaction();
+
+    txSize = 0;
+    return true;
+}
+
+size_t StreamingUDP::writeBytes(const void* data, size_t size) {
+    if (size > static_cast<size_t>(txFree - txSize))
+        size = txFree - txSize;
+    if (size == 0)
+        return 0;
+
+    writeAt(txSize, static_cast<const uint8_t*>(data), size);
+
+    txSize += size;
+    return size;
+}
+
+bool StreamingUDP::patchBytes(const size_t position, const void* data, const size_t size) {
+    if (position + size > txSize)
+        return false;
+
+    writeAt(position, static_cast<const uint8_t*>(data), size);
+    return true;
+}
+
+void StreamingUDP::writeAt(const uint16_t position, const uint8_t* bytes, const size_t size) {
+    const uint16_t offset = (txStart + position) & W5100.SMASK;
+    const uint16_t address = W5100.SBASE(sockindex) + offset;
+
+    SPI.beginTransaction(SPI_ETHERNET_SETTINGS);
+    if (W5100.hasOffsetAddressMapping() || offset + size <= W5100.SSIZE) {
+        W5100.write(address, bytes, size);
+    } else {
+        const uint16_t head = W5100.SSIZE - offset;
+        W5100.write(address, bytes, head);
+        W5100.write(W5100.SBASE(sockindex), bytes + head, size - head);
+    }
+    SPI.endTransaction();
+}
+
+void StreamingUDP::truncateResponse(const size_t size) {
+    if (size < txSize)
+        txSize = size;
+}
+
+void StreamingUDP::endResponse() {
+    SPI.beginTransaction(SPI_ETHERNET_SETTINGS);
+    W5100.writeSnTX_WR(sockindex, txStart + txSize);
+    W5100.execCmdSn(sockindex, Sock_SEND);
+    SPI.endTransaction();
+
+    sending = true;
+    sendStart = millis();
+}
+
+size_t StreamingUDP::readResponse(char* dest, size_t maxSize) {
+    if (maxSize > txSize)
+        maxSize = txSize;
+
+    auto* bytes = reinterpret_cast<uint8_t*>(dest);
+    const uint16_t offset = txStart & W5100.SMASK;
+    const uint16_t address = W5100.SBASE(sockindex) + offset;
+
+    SPI.beginTransaction(SPI_ETHERNET_SETTINGS);
+    if (W5100.hasOffsetAddressMapping() || offset + maxSize <= W5100.SSIZE) {
+        W5100.read(address, bytes, maxSize);
+    } else {
+        const uint16_t head = W5100.SSIZE - offset;
+        W5100.read(address, bytes, head);
+        W5100.read(W5100.SBASE(sockindex), bytes + head, maxSize - head);
+    }
+    SPI.endTransaction();
+
+    return maxSize;
+}
+
+size_t StreamingUDP::getResponseSize() const {
+    return txSize;
+}
+
+uint16_t StreamingUDP::getFailedSends() const {
+    return failedSends;
+}
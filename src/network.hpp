@@ -0,0 +1,87 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__NETWORK__H
+#define STATION_MGMT__NETWORK__H
+
+#include <Ethernet.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "utils.hpp"
+
+// Longer than the W5100 ARP retry window (RTR x RCR), after which SEND reports a timeout by itself
+#define NETWORK_SEND_TIMEOUT 3000
+
+class StreamingUDP : public EthernetUDP {
+    public:
+
+        StreamingUDP();
+
+        ~StreamingUDP();
+
+        bool isSending();
+
+        bool beginResponse(const IPAddress& ip, uint16_t port);
+
+        size_t writeBytes(const void* data, size_t size);
+
+        template <typename T>
+        size_t writeValue(T value) {
+            swapEndianness(&value, sizeof(T));
+            return writeBytes(&value, sizeof(T));
+        }
+
+        // Overwrites bytes already in the response, for a length only known once what follows is written
+        bool patchBytes(size_t position, const void* data, size_t size);
+
+        template <typename T>
+        bool patchValue(const size_t position, T value) {
+            swapEndianness(&value, sizeof(T));
+            return patchBytes(position, &value, sizeof(T));
+        }
+
+        void truncateResponse(size_t size);
+
+        void endResponse();
+
+        size_t readResponse(char* dest, size_t maxSize);
+
+        [[nodiscard]]
+        size_t getResponseSize() const;
+
+        [[nodiscard]]
+        uint16_t getFailedSends() const;
+
+    private:
+
+        bool sending;
+        unsigned long sendStart;
+        uint16_t failedSends;
+
+        uint16_t txStart;
+        uint16_t txFree;
+        uint16_t txSize;
+
+        void writeAt(uint16_t position, const uint8_t* bytes, size_t size);
+};
+
+#endif
@@ -25,13 +25,13 @@
 #include <EEPROM.h>
 
 #include "eeprom.hpp"
+#include "events.hpp"
 
-Relais* Relais::instance = nullptr;
+#ifdef RELAIS_ENABLED
+Relais Relais::instance;
 
 Relais* Relais::getInstance() {
-    if (instance == nullptr)
-        instance = new Relais();
-    return instance;
+    return &instance;
 }
 
 Relais::Relais() {
@@ -45,7 +45,20 @@ bool Relais::getStatus(const int item) const {
     return status[item];
 }
 
+uint8_t Relais::getEnabled() const {
+    uint8_t enabled = 0;
+    for (uint8_t i = 0; i < RELAIS_NUMBER; i++)
+        if (status[i])
+            enabled |= 1 << i;
+
+    return enabled;
+}
+
 void Relais::setStatus(const int item, const bool newStatus) {
+    if (status[item] != newStatus)
+        Events::getInstance()->publish(EventCode::Relais, item, newStatus ? 0x01 : 0x00);
+
     status[item] = newStatus;
     EEPROM.write(EEPROM_ADDRESS_RELAIS_START + item, newStatus ? 0x01 : 0x00);
 }
+#endif
@@ -22,6 +22,8 @@
 #ifndef STATION_MGMT__OUTPUT__H
 #define STATION_MGMT__OUTPUT__H
 
+#include <stdint.h>
+
 #include "const.hpp"
 
 #define RELAIS_NUMBER 8
@@ -34,11 +36,14 @@ class Relais {
         [[nodiscard]]
         bool getStatus(int item) const;
 
+        [[nodiscard]]
+        uint8_t getEnabled() const;
+
         void setStatus(int item, bool newStatus);
 
     private:
 
-        static Relais* instance;
+        static Relais instance;
 
         explicit Relais();
 
@@ -0,0 +1,162 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "sdlog.hpp"
+
+#include <string.h>
+
+#include "const.hpp"
+#include "utils.hpp"
+
+#ifdef SD_LOGGER_ENABLED
+    #ifndef ARDUINO
+        #include <stdlib.h>
+    #endif
+
+SdLogger::SdLogger() {
+    ready = false;
+    blockCount = 0;
+    blockDay = 0xFFFF;
+    blockSequence = 0;
+    blockPending = false;
+    carryDay = 0;
+    carryPending = false;
+    droppedSamples = 0;
+}
+
+SdLogger::~SdLogger() = default;
+
+bool SdLogger::begin() {
+    #ifdef ARDUINO
+    ready = device.begin(PIN_ETHERNET_SD_ENABLE);
+    #else
+    const char* directory = getenv(SD_LOGGER_HOST_DIRECTORY_ENV);
+    ready = device.begin(directory != nullptr ? directory : ".");
+    #endif
+    return ready;
+}
+
+void SdLogger::push(
+    const uint64_t timestamp,
+    const float panelVoltage,
+    const float panelCurrent,
+    const float batteryVoltage,
+    const float batteryChargeCurrent,
+    const float batteryVoltageFiltered) {
+    char record[SD_LOGGER_RECORD_SIZE];
+    size_t size = 0;
+    size += packValue(record + size, timestamp);
+    size += packValue(record + size, panelVoltage);
+    size += packValue(record + size, panelCurrent);
+    size += packValue(record + size, batteryVoltage);
+    size += packValue(record + size, batteryChargeCurrent);
+    packValue(record + size, batteryVoltageFiltered);
+
+    const uint16_t day = timestamp / SD_LOGGER_DAY_LENGTH;
+
+    // While a sealed block waits for the bus a single sample is parked, anything more is dropped
+    if (blockPending) {
+        if (carryPending) {
+            droppedSamples++;
+        } else {
+            memcpy(carry, record, SD_LOGGER_RECORD_SIZE);
+            carryDay = day;
+            carryPending = true;
+        }
+        return;
+    }
+
+    append(day, reinterpret_cast<const uint8_t*>(record));
+}
+
+void SdLogger::flush() {
+    if (!blockPending)
+        return;
+
+    if (!ready || !device.appendBlock(blockDay, block))
+        droppedSamples += blockCount;
+
+    blockSequence++;
+    blockCount = 0;
+    blockPending = false;
+
+    if (carryPending) {
+        carryPending = false;
+        append(carryDay, carry);
+    }
+}
+
+int SdLogger::read(const uint16_t day, const uint32_t offset, uint8_t* dest, const uint16_t size) {
+    if (!ready)
+        return -1;
+
+    return device.readFile(day, offset, dest, size);
+}
+
+bool SdLogger::isReady() const {
+    return ready;
+}
+
+BlockDevice* SdLogger::getDevice() {
+    return &device;
+}
+
+uint16_t SdLogger::getDroppedSamples() const {
+    return droppedSamples;
+}
+
+void SdLogger::append(const uint16_t day, const uint8_t* record) {
+    // Day rotation seals the partial block, the new sample opens the next file once it is written
+    if (blockCount > 0 && day != blockDay) {
+        seal();
+        memcpy(carry, record, SD_LOGGER_RECORD_SIZE);
+        carryDay = day;
+        carryPending = true;
+        return;
+    }
+
+    if (blockCount == 0 && day != blockDay) {
+        blockDay = day;
+        blockSequence = 0;
+    }
+
+    memcpy(block + SD_LOGGER_HEADER_SIZE + blockCount * SD_LOGGER_RECORD_SIZE, record, SD_LOGGER_RECORD_SIZE);
+    blockCount++;
+
+    if (blockCount == SD_LOGGER_RECORDS_PER_BLOCK)
+        seal();
+}
+
+void SdLogger::seal() {
+    auto* header = reinterpret_cast<char*>(block);
+    size_t size = 0;
+    size += packValue(header + size, static_cast<uint16_t>(SD_LOGGER_MAGIC));
+    size += packValue(header + size, static_cast<uint8_t>(SD_LOGGER_VERSION));
+    size += packValue(header + size, blockCount);
+    size += packValue(header + size, blockDay);
+    packValue(header + size, blockSequence);
+
+    const size_t used = SD_LOGGER_HEADER_SIZE + blockCount * SD_LOGGER_RECORD_SIZE;
+    memset(block + used, 0, BLOCK_DEVICE_BLOCK_SIZE - used);
+
+    blockPending = true;
+}
+#endif
@@ -0,0 +1,95 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__SDLOG__H
+#define STATION_MGMT__SDLOG__H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "blockdev.hpp"
+
+#define SD_LOGGER_MAGIC 0x534C
+#define SD_LOGGER_VERSION 0x02
+#define SD_LOGGER_HEADER_SIZE 8
+#define SD_LOGGER_RECORD_SIZE 28
+#define SD_LOGGER_RECORDS_PER_BLOCK ((BLOCK_DEVICE_BLOCK_SIZE - SD_LOGGER_HEADER_SIZE) / SD_LOGGER_RECORD_SIZE)
+// Samples are filed per day of station time, Unix days once the clock has been synced
+#define SD_LOGGER_DAY_LENGTH 86400000UL
+#define SD_LOGGER_CHUNK_SIZE 128
+#define SD_LOGGER_HOST_DIRECTORY_ENV "STATION_SD_DIRECTORY"
+
+#ifdef SD_LOGGER_ENABLED
+class SdLogger {
+    public:
+
+        SdLogger();
+
+        ~SdLogger();
+
+        bool begin();
+
+        void push(
+            uint64_t timestamp,
+            float panelVoltage,
+            float panelCurrent,
+            float batteryVoltage,
+            float batteryChargeCurrent,
+            float batteryVoltageFiltered);
+
+        void flush();
+
+        int read(uint16_t day, uint32_t offset, uint8_t* dest, uint16_t size);
+
+        [[nodiscard]]
+        bool isReady() const;
+
+        [[nodiscard]]
+        BlockDevice* getDevice();
+
+        [[nodiscard]]
+        uint16_t getDroppedSamples() const;
+
+    private:
+
+        BlockDevice device;
+        bool ready;
+
+        uint8_t block[BLOCK_DEVICE_BLOCK_SIZE];
+        uint8_t blockCount;
+        uint16_t blockDay;
+        uint16_t blockSequence;
+        bool blockPending;
+
+        uint8_t carry[SD_LOGGER_RECORD_SIZE];
+        uint16_t carryDay;
+        bool carryPending;
+
+        uint16_t droppedSamples;
+
+        void append(uint16_t day, const uint8_t* record);
+
+        void seal();
+};
+
+#endif
+
+#endif
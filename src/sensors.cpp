@@ -0,0 +1,147 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "sensors.hpp"
+
+#include <Arduino.h>
+
+#include "const.hpp"
+
+#ifdef SENSORS_ENABLED
+Sensors Sensors::instance;
+
+Sensors* Sensors::getInstance() {
+    return &instance;
+}
+
+Sensors::Sensors() {
+    count = 0;
+    conversionStart = 0;
+
+    for (uint8_t id = 0; id < SENSORS_MAX_DRIVERS; id++) {
+        drivers[id] = nullptr;
+        status[id] = SensorStatus::NoData;
+        converting[id] = false;
+        for (float& value : values[id])
+            value = 0;
+    }
+}
+
+Sensors::~Sensors() = default;
+
+uint8_t Sensors::add(SensorDriver* driver) {
+    if (count == SENSORS_MAX_DRIVERS || driver->getChannelCount() > SENSORS_MAX_CHANNELS)
+        return SENSORS_NONE;
+
+    drivers[count] = driver;
+    return count++;
+}
+
+void Sensors::begin() {
+    for (uint8_t id = 0; id < count; id++)
+        drivers[id]->init();
+}
+
+void Sensors::acquire() {
+    conversionStart = millis();
+
+    // Every conversion is started in the same pass, so their conversion times overlap
+    for (uint8_t id = 0; id < count; id++) {
+        if (converting[id])
+            continue;
+
+        converting[id] = drivers[id]->startConversion();
+        if (!converting[id] && status[id] == SensorStatus::Valid)
+            status[id] = SensorStatus::Stale;
+    }
+}
+
+uint8_t Sensors::poll() {
+    // One bit per sensor whose values were refreshed in this pass
+    uint8_t updated = 0;
+
+    for (uint8_t id = 0; id < count; id++) {
+        if (!converting[id])
+            continue;
+
+        if (!drivers[id]->isReady()) {
+            if (millis() - conversionStart > SENSORS_CONVERSION_TIMEOUT) {
+                converting[id] = false;
+                if (status[id] == SensorStatus::Valid)
+                    status[id] = SensorStatus::Stale;
+            }
+            continue;
+        }
+
+        converting[id] = false;
+
+        if (drivers[id]->read(values[id]) == drivers[id]->getChannelCount()) {
+            status[id] = SensorStatus::Valid;
+            updated |= 1 << id;
+        } else if (status[id] == SensorStatus::Valid) {
+            status[id] = SensorStatus::Stale;
+        }
+    }
+
+    return updated;
+}
+
+uint8_t Sensors::getCount() const {
+    return count;
+}
+
+uint8_t Sensors::find(const SensorType type) const {
+    for (uint8_t id = 0; id < count; id++)
+        if (drivers[id]->getType() == type)
+            return id;
+
+    return SENSORS_NONE;
+}
+
+SensorType Sensors::getType(const uint8_t id) const {
+    return drivers[id]->getType();
+}
+
+uint8_t Sensors::getChannelCount(const uint8_t id) const {
+    if (id >= count)
+        return 0;
+
+    return drivers[id]->getChannelCount();
+}
+
+SensorQuantity Sensors::getQuantity(const uint8_t id, const uint8_t channel) const {
+    return drivers[id]->getQuantity(channel);
+}
+
+SensorStatus Sensors::getStatus(const uint8_t id) const {
+    if (id >= count)
+        return SensorStatus::NoData;
+
+    return status[id];
+}
+
+float Sensors::getValue(const uint8_t id, const uint8_t channel) const {
+    if (id >= count || channel >= SENSORS_MAX_CHANNELS)
+        return 0;
+
+    return values[id][channel];
+}
+#endif
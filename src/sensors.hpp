@@ -0,0 +1,151 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__SENSORS__H
+#define STATION_MGMT__SENSORS__H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SENSORS_MAX_DRIVERS 4
+#define SENSORS_MAX_CHANNELS 3
+#define SENSORS_CONVERSION_TIMEOUT 500
+
+#define SENSORS_NONE 0xFF
+
+enum class SensorType : uint8_t {
+    Bmp280 = 0x01,
+    Ina219 = 0x02
+};
+
+enum class SensorQuantity : uint8_t {
+    Temperature = 0x01,    // °C
+    Pressure = 0x02,       // hPa
+    Voltage = 0x03,        // V
+    Current = 0x04,        // A
+    Power = 0x05           // W
+};
+
+enum class SensorStatus : uint8_t {
+    NoData = 0x00,
+    Valid = 0x01,
+    Stale = 0x02
+};
+
+class SensorDriver {
+    public:
+
+        virtual ~SensorDriver() = default;
+
+        virtual void init() = 0;
+
+        virtual bool startConversion() = 0;
+
+        virtual bool isReady() = 0;
+
+        virtual uint8_t read(float* values) = 0;
+
+        [[nodiscard]]
+        virtual SensorType getType() const = 0;
+
+        [[nodiscard]]
+        virtual uint8_t getChannelCount() const = 0;
+
+        [[nodiscard]]
+        virtual SensorQuantity getQuantity(uint8_t channel) const = 0;
+};
+
+class Sensors {
+    public:
+
+        static Sensors* getInstance();
+
+        uint8_t add(SensorDriver* driver);
+
+        void begin();
+
+        void acquire();
+
+        uint8_t poll();
+
+        [[nodiscard]]
+        uint8_t getCount() const;
+
+        [[nodiscard]]
+        uint8_t find(SensorType type) const;
+
+        [[nodiscard]]
+        SensorType getType(uint8_t id) const;
+
+        [[nodiscard]]
+        uint8_t getChannelCount(uint8_t id) const;
+
+        [[nodiscard]]
+        SensorQuantity getQuantity(uint8_t id, uint8_t channel) const;
+
+        [[nodiscard]]
+        SensorStatus getStatus(uint8_t id) const;
+
+        [[nodiscard]]
+        float getValue(uint8_t id, uint8_t channel) const;
+
+        template <typename W>
+        size_t serialize(W& writer) const;
+
+    private:
+
+        static Sensors instance;
+
+        explicit Sensors();
+
+        ~Sensors();
+
+        SensorDriver* drivers[SENSORS_MAX_DRIVERS];
+        uint8_t count;
+
+        float values[SENSORS_MAX_DRIVERS][SENSORS_MAX_CHANNELS];
+        SensorStatus status[SENSORS_MAX_DRIVERS];
+        bool converting[SENSORS_MAX_DRIVERS];
+        unsigned long conversionStart;
+};
+
+template <typename W>
+size_t Sensors::serialize(W& writer) const {
+    size_t size = 0;
+    size += writer.writeValue(count);
+
+    for (uint8_t id = 0; id < count; id++) {
+        const uint8_t channels = drivers[id]->getChannelCount();
+
+        size += writer.writeValue(drivers[id]->getType());
+        size += writer.writeValue(status[id]);
+        size += writer.writeValue(channels);
+
+        for (uint8_t channel = 0; channel < channels; channel++) {
+            size += writer.writeValue(drivers[id]->getQuantity(channel));
+            size += writer.writeValue(values[id][channel]);
+        }
+    }
+
+    return size;
+}
+
+#endif
@@ -0,0 +1,224 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "shedder.hpp"
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <math.h>
+#include <string.h>
+
+#include "eeprom.hpp"
+#include "events.hpp"
+#include "utils.hpp"
+
+#ifdef RELAIS_ENABLED
+LoadShedder::LoadShedder() {
+    uint8_t header[SHEDDER_HEADER_SIZE];
+    uint8_t data[SHEDDER_DATA_SIZE];
+    for (uint8_t i = 0; i < SHEDDER_HEADER_SIZE; i++)
+        header[i] = EEPROM.read(EEPROM_ADDRESS_SHEDDER + i);
+    for (uint8_t i = 0; i < SHEDDER_DATA_SIZE; i++)
+        data[i] = EEPROM.read(EEPROM_ADDRESS_SHEDDER + SHEDDER_HEADER_SIZE + i);
+
+    uint16_t magic;
+    uint16_t crc;
+    memcpy(&magic, header, sizeof(uint16_t));
+    memcpy(&crc, header + 2, sizeof(uint16_t));
+    const bool legacy = magic == SHEDDER_LEGACY_MAGIC && crc == crc16(data, SHEDDER_LEGACY_DATA_SIZE);
+    const bool stored = legacy || (magic == SHEDDER_MAGIC && crc == crc16(data, SHEDDER_DATA_SIZE));
+    const uint8_t entrySize = legacy ? SHEDDER_LEGACY_ENTRY_SIZE : SHEDDER_ENTRY_SIZE;
+
+    // Without a stored table every channel follows the global status, as before load shedding existed
+    for (uint8_t i = 0; i < RELAIS_NUMBER; i++) {
+        LoadSettings& settings = loads[i];
+        const uint8_t* entry = data + i * entrySize;
+        settings.priority = entry[0];
+        memcpy(&settings.offVoltage, entry + 1, sizeof(float));
+        memcpy(&settings.onVoltage, entry + 5, sizeof(float));
+        if (legacy)
+            settings.settleTime = SHEDDER_SETTLE_TIME_DEFAULT;
+        else
+            memcpy(&settings.settleTime, entry + 9, sizeof(uint16_t));
+
+        if (!stored || !isValid(settings))
+            settings = {0, 0.0f, 0.0f, SHEDDER_SETTLE_TIME_DEFAULT};
+
+        changedAt[i] = 0;
+    }
+
+    powered = 0xFF;
+    dwelling = 0x00;
+    minOnTime = 0;
+    minOffTime = 0;
+
+    rank();
+
+    if (legacy)
+        commit();
+}
+
+LoadShedder::~LoadShedder() = default;
+
+void LoadShedder::setDwellTimes(const uint16_t minOnTime, const uint16_t minOffTime) {
+    this->minOnTime = minOnTime * 1000UL;
+    this->minOffTime = minOffTime * 1000UL;
+}
+
+uint8_t LoadShedder::evaluate(const float voltage, const uint8_t enabled, const unsigned long now) {
+    uint8_t below = 0;
+    uint8_t above = 0;
+
+    for (uint8_t i = 0; i < RELAIS_NUMBER; i++) {
+        const uint8_t bit = 1 << i;
+        if (voltage <= loads[i].offVoltage)
+            below |= bit;
+        if (voltage >= loads[i].onVoltage)
+            above |= bit;
+
+        const unsigned long dwell = (powered & bit) != 0 ? minOnTime : minOffTime;
+        if ((dwelling & bit) != 0 && now - changedAt[i] >= dwell)
+            dwelling &= ~bit;
+    }
+
+    // Only enabled channels with a threshold hold up the order, a load switched off by hand has nothing to shed
+    const uint8_t active = enabled & managed;
+    const uint8_t shedding = powered & below & managed & ~dwelling;
+    const uint8_t restoring = ~powered & (above | ~managed) & ~dwelling;
+
+    uint8_t changed = 0;
+    for (uint8_t i = 0; i < RELAIS_NUMBER; i++) {
+        const uint8_t bit = 1 << i;
+        const uint8_t higherRanked = ~lowerRanked[i] & ~bit;
+
+        if ((shedding & bit) != 0 && (powered & active & lowerRanked[i]) == 0)
+            changed |= bit;
+        else if ((restoring & bit) != 0 && (~powered & active & higherRanked) == 0)
+            changed |= bit;
+    }
+
+    if (changed == 0)
+        return powered;
+
+    powered ^= changed;
+    dwelling |= changed;
+
+    for (uint8_t i = 0; i < RELAIS_NUMBER; i++) {
+        const uint8_t bit = 1 << i;
+        if ((changed & bit) == 0)
+            continue;
+
+        changedAt[i] = now;
+        Events::getInstance()->publish(EventCode::LoadShedding, i, (powered & bit) != 0 ? 0x01 : 0x00);
+    }
+
+    return powered;
+}
+
+uint8_t LoadShedder::getPowered() const {
+    return powered;
+}
+
+const LoadSettings& LoadShedder::getSettings(const uint8_t channel) const {
+    return loads[channel];
+}
+
+uint8_t LoadShedder::getHigherRanked(const uint8_t channel) const {
+    return ~lowerRanked[channel] & ~(1 << channel);
+}
+
+bool LoadShedder::setSettings(const uint8_t channel, const LoadSettings& settings) {
+    if (channel >= RELAIS_NUMBER || !isValid(settings))
+        return false;
+
+    loads[channel] = settings;
+    rank();
+    commit();
+    return true;
+}
+
+bool LoadShedder::deserialize(const char* src, const size_t size) {
+    if (size < 1 + SHEDDER_ENTRY_SIZE)
+        return false;
+
+    LoadSettings settings;
+    settings.priority = static_cast<uint8_t>(src[1]);
+    memcpy(&settings.offVoltage, src + 2, sizeof(float));
+    swapEndianness(&settings.offVoltage, sizeof(float));
+    memcpy(&settings.onVoltage, src + 6, sizeof(float));
+    swapEndianness(&settings.onVoltage, sizeof(float));
+    memcpy(&settings.settleTime, src + 10, sizeof(uint16_t));
+    swapEndianness(&settings.settleTime, sizeof(uint16_t));
+
+    return setSettings(static_cast<uint8_t>(src[0]), settings);
+}
+
+void LoadShedder::rank() {
+    managed = 0;
+
+    for (uint8_t i = 0; i < RELAIS_NUMBER; i++) {
+        if (loads[i].offVoltage > 0)
+            managed |= 1 << i;
+
+        lowerRanked[i] = 0;
+        for (uint8_t j = 0; j < RELAIS_NUMBER; j++) {
+            const uint8_t priority = loads[i].priority;
+            const uint8_t other = loads[j].priority;
+            if (other < priority || (other == priority && j < i))
+                lowerRanked[i] |= 1 << j;
+        }
+    }
+}
+
+void LoadShedder::commit() const {
+    uint8_t data[SHEDDER_DATA_SIZE];
+    for (uint8_t i = 0; i < RELAIS_NUMBER; i++) {
+        uint8_t* entry = data + i * SHEDDER_ENTRY_SIZE;
+        entry[0] = loads[i].priority;
+        memcpy(entry + 1, &loads[i].offVoltage, sizeof(float));
+        memcpy(entry + 5, &loads[i].onVoltage, sizeof(float));
+        memcpy(entry + 9, &loads[i].settleTime, sizeof(uint16_t));
+    }
+
+    const uint16_t magic = SHEDDER_MAGIC;
+    const uint16_t crc = crc16(data, SHEDDER_DATA_SIZE);
+    uint8_t header[SHEDDER_HEADER_SIZE];
+    memcpy(header, &magic, sizeof(uint16_t));
+    memcpy(header + 2, &crc, sizeof(uint16_t));
+
+    for (uint8_t i = 0; i < SHEDDER_DATA_SIZE; i++)
+        EEPROM.update(EEPROM_ADDRESS_SHEDDER + SHEDDER_HEADER_SIZE + i, data[i]);
+    for (uint8_t i = 0; i < SHEDDER_HEADER_SIZE; i++)
+        EEPROM.update(EEPROM_ADDRESS_SHEDDER + i, header[i]);
+}
+
+bool LoadShedder::isValid(const LoadSettings& settings) {
+    if (isnan(settings.offVoltage) || isnan(settings.onVoltage))
+        return false;
+
+    if (settings.offVoltage < 0 || settings.onVoltage > SHEDDER_VOLTAGE_MAX
+        || settings.settleTime > SHEDDER_SETTLE_TIME_MAX)
+        return false;
+
+    // A managed channel needs hysteresis, or it would flap around a single threshold
+    return settings.offVoltage == 0 ? settings.onVoltage == 0 : settings.onVoltage > settings.offVoltage;
+}
+#endif
@@ -0,0 +1,115 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__SHEDDER__H
+#define STATION_MGMT__SHEDDER__H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "relais.hpp"
+
+#define SHEDDER_MAGIC 0x4C54
+#define SHEDDER_HEADER_SIZE 4
+#define SHEDDER_ENTRY_SIZE 11
+#define SHEDDER_DATA_SIZE (RELAIS_NUMBER * SHEDDER_ENTRY_SIZE)
+// First layout, without the settle time, migrated when it is found
+#define SHEDDER_LEGACY_MAGIC 0x4C53
+#define SHEDDER_LEGACY_ENTRY_SIZE 9
+#define SHEDDER_LEGACY_DATA_SIZE (RELAIS_NUMBER * SHEDDER_LEGACY_ENTRY_SIZE)
+#define SHEDDER_VOLTAGE_MAX 100.0f
+#define SHEDDER_SETTLE_TIME_DEFAULT 500
+#define SHEDDER_SETTLE_TIME_MAX 10000
+
+struct LoadSettings {
+        uint8_t priority;
+        float offVoltage;
+        float onVoltage;
+        uint16_t settleTime;
+};
+
+// Sheds the relais one at a time as the battery drops, lowest priority first, and restores them in reverse order
+// as it recovers. Ties in priority shed the lower channel first. A zero off voltage leaves the channel to the
+// global status alone. The settle time is how long RelaisSwitcher waits after turning the channel on.
+class LoadShedder {
+    public:
+
+        LoadShedder();
+
+        ~LoadShedder();
+
+        void setDwellTimes(uint16_t minOnTime, uint16_t minOffTime);
+
+        uint8_t evaluate(float voltage, uint8_t enabled, unsigned long now);
+
+        [[nodiscard]]
+        uint8_t getPowered() const;
+
+        [[nodiscard]]
+        const LoadSettings& getSettings(uint8_t channel) const;
+
+        [[nodiscard]]
+        uint8_t getHigherRanked(uint8_t channel) const;
+
+        bool setSettings(uint8_t channel, const LoadSettings& settings);
+
+        bool deserialize(const char* src, size_t size);
+
+        template <typename W>
+        size_t serialize(W& writer) const;
+
+    private:
+
+        LoadSettings loads[RELAIS_NUMBER];
+        uint8_t lowerRanked[RELAIS_NUMBER];
+        uint8_t managed;
+
+        uint8_t powered;
+        uint8_t dwelling;
+        unsigned long changedAt[RELAIS_NUMBER];
+
+        unsigned long minOnTime;
+        unsigned long minOffTime;
+
+        void rank();
+
+        void commit() const;
+
+        static bool isValid(const LoadSettings& settings);
+};
+
+template <typename W>
+size_t LoadShedder::serialize(W& writer) const {
+    size_t size = 0;
+    size += writer.writeValue(powered);
+    size += writer.writeValue(static_cast<uint8_t>(RELAIS_NUMBER));
+
+    for (const LoadSettings& settings : loads) {
+        size += writer.writeValue(settings.priority);
+        size += writer.writeValue(settings.offVoltage);
+        size += writer.writeValue(settings.onVoltage);
+        size += writer.writeValue(settings.settleTime);
+    }
+
+    return size;
+}
+
+#endif
@@ -0,0 +1,147 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "stats.hpp"
+
+Statistics::Statistics() {
+    epoch = 0;
+    lastTimestamp = 0;
+    lastPanelPower = 0;
+    lastBatteryChargeCurrent = 0;
+    reset(0);
+}
+
+Statistics::~Statistics() = default;
+
+void Statistics::push(
+    const unsigned long timestamp,
+    const float batteryVoltage,
+    const float batteryChargeCurrent,
+    const float panelVoltage,
+    const float panelCurrent) {
+    const float panelPower = panelVoltage * panelCurrent;
+
+    if (samples == 0) {
+        batteryVoltageMin = batteryVoltage;
+        batteryVoltageMax = batteryVoltage;
+        panelPowerMin = panelPower;
+        panelPowerMax = panelPower;
+    } else {
+        if (batteryVoltage < batteryVoltageMin)
+            batteryVoltageMin = batteryVoltage;
+        if (batteryVoltage > batteryVoltageMax)
+            batteryVoltageMax = batteryVoltage;
+        if (panelPower < panelPowerMin)
+            panelPowerMin = panelPower;
+        if (panelPower > panelPowerMax)
+            panelPowerMax = panelPower;
+    }
+
+    // Left Riemann sum over the previous sample, steps across an outage are not integrated. The previous sample
+    // survives a reset, so the step across it goes to the new epoch instead of getting lost.
+    const unsigned long step = timestamp - lastTimestamp;
+    if (step <= STATS_MAX_INTEGRATION_STEP) {
+        const float seconds = static_cast<float>(step) / 1000.0f;
+
+        energyWattSeconds += lastPanelPower * seconds;
+        if (energyWattSeconds >= 3600.0f) {
+            energyWattHours += energyWattSeconds / 3600.0f;
+            energyWattSeconds = 0;
+        }
+
+        chargeAmpSeconds += lastBatteryChargeCurrent * seconds;
+        if (chargeAmpSeconds >= 3600.0f) {
+            chargeAmpHours += chargeAmpSeconds / 3600.0f;
+            chargeAmpSeconds = 0;
+        }
+    }
+
+    samples++;
+    batteryVoltageMean += (batteryVoltage - batteryVoltageMean) / static_cast<float>(samples);
+    panelPowerMean += (panelPower - panelPowerMean) / static_cast<float>(samples);
+
+    lastTimestamp = timestamp;
+    lastPanelPower = panelPower;
+    lastBatteryChargeCurrent = batteryChargeCurrent;
+}
+
+void Statistics::reset(const unsigned long timestamp) {
+    epoch++;
+    epochStart = timestamp;
+    samples = 0;
+
+    batteryVoltageMin = 0;
+    batteryVoltageMax = 0;
+    batteryVoltageMean = 0;
+
+    panelPowerMin = 0;
+    panelPowerMax = 0;
+    panelPowerMean = 0;
+
+    energyWattHours = 0;
+    energyWattSeconds = 0;
+    chargeAmpHours = 0;
+    chargeAmpSeconds = 0;
+}
+
+uint16_t Statistics::getEpoch() const {
+    return epoch;
+}
+
+uint32_t Statistics::getDuration(const unsigned long timestamp) const {
+    return (timestamp - epochStart) / 1000UL;
+}
+
+uint32_t Statistics::getSamples() const {
+    return samples;
+}
+
+float Statistics::getBatteryVoltageMin() const {
+    return batteryVoltageMin;
+}
+
+float Statistics::getBatteryVoltageMax() const {
+    return batteryVoltageMax;
+}
+
+float Statistics::getBatteryVoltageMean() const {
+    return batteryVoltageMean;
+}
+
+float Statistics::getPanelPowerMin() const {
+    return panelPowerMin;
+}
+
+float Statistics::getPanelPowerMax() const {
+    return panelPowerMax;
+}
+
+float Statistics::getPanelPowerMean() const {
+    return panelPowerMean;
+}
+
+float Statistics::getEnergyHarvested() const {
+    return energyWattHours + energyWattSeconds / 3600.0f;
+}
+
+float Statistics::getChargeAccumulated() const {
+    return chargeAmpHours + chargeAmpSeconds / 3600.0f;
+}
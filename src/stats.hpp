@@ -0,0 +1,101 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__STATS__H
+#define STATION_MGMT__STATS__H
+
+#include <stdint.h>
+
+#define STATS_MAX_INTEGRATION_STEP 5000
+
+class Statistics {
+    public:
+
+        Statistics();
+
+        ~Statistics();
+
+        void push(
+            unsigned long timestamp,
+            float batteryVoltage,
+            float batteryChargeCurrent,
+            float panelVoltage,
+            float panelCurrent);
+
+        void reset(unsigned long timestamp);
+
+        [[nodiscard]]
+        uint16_t getEpoch() const;
+
+        [[nodiscard]]
+        uint32_t getDuration(unsigned long timestamp) const;
+
+        [[nodiscard]]
+        uint32_t getSamples() const;
+
+        [[nodiscard]]
+        float getBatteryVoltageMin() const;
+
+        [[nodiscard]]
+        float getBatteryVoltageMax() const;
+
+        [[nodiscard]]
+        float getBatteryVoltageMean() const;
+
+        [[nodiscard]]
+        float getPanelPowerMin() const;
+
+        [[nodiscard]]
+        float getPanelPowerMax() const;
+
+        [[nodiscard]]
+        float getPanelPowerMean() const;
+
+        [[nodiscard]]
+        float getEnergyHarvested() const;
+
+        [[nodiscard]]
+        float getChargeAccumulated() const;
+
+    private:
+
+        uint16_t epoch;
+        unsigned long epochStart;
+        unsigned long lastTimestamp;
+        uint32_t samples;
+
+        float batteryVoltageMin;
+        float batteryVoltageMax;
+        float batteryVoltageMean;
+
+        float panelPowerMin;
+        float panelPowerMax;
+        float panelPowerMean;
+        float lastPanelPower;
+        float lastBatteryChargeCurrent;
+
+        float energyWattHours;
+        float energyWattSeconds;
+        float chargeAmpHours;
+        float chargeAmpSeconds;
+};
+
+#endif
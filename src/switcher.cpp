@@ -0,0 +1,89 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "switcher.hpp"
+
+#include <Arduino.h>
+
+#ifdef RELAIS_ENABLED
+RelaisSwitcher::RelaisSwitcher() {
+    pins = nullptr;
+    target = 0x00;
+    applied = 0x00;
+    settling = false;
+    switchedAt = 0;
+    settleTime = 0;
+}
+
+RelaisSwitcher::~RelaisSwitcher() = default;
+
+void RelaisSwitcher::begin(const int* pins) {
+    this->pins = pins;
+}
+
+void RelaisSwitcher::setTarget(const uint8_t outputs) {
+    target = outputs;
+}
+
+void RelaisSwitcher::poll(const LoadShedder& loads, const unsigned long now) {
+    if (pins == nullptr)
+        return;
+
+    // Releasing a load draws nothing from the battery, there is no reason to wait for it
+    const uint8_t releasing = applied & ~target;
+    if (releasing != 0) {
+        for (uint8_t i = 0; i < RELAIS_NUMBER; i++)
+            if ((releasing & (1 << i)) != 0)
+                digitalWrite(pins[i], HIGH);
+        applied &= ~releasing;
+    }
+
+    if (settling) {
+        if (now - switchedAt < settleTime)
+            return;
+        settling = false;
+    }
+
+    const uint8_t pending = target & ~applied;
+    if (pending == 0)
+        return;
+
+    for (uint8_t i = 0; i < RELAIS_NUMBER; i++) {
+        if ((pending & (1 << i)) == 0 || (pending & loads.getHigherRanked(i)) != 0)
+            continue;
+
+        digitalWrite(pins[i], LOW);
+        applied |= 1 << i;
+        settling = true;
+        switchedAt = now;
+        settleTime = loads.getSettings(i).settleTime;
+        return;
+    }
+}
+
+uint8_t RelaisSwitcher::getApplied() const {
+    return applied;
+}
+
+bool RelaisSwitcher::isSettling() const {
+    return settling || (target & ~applied) != 0;
+}
+#endif
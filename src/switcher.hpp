@@ -0,0 +1,63 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__SWITCHER__H
+#define STATION_MGMT__SWITCHER__H
+
+#include <stdint.h>
+
+#include "shedder.hpp"
+
+// Drives the relais pins towards the requested outputs without blocking the loop. Turn-offs are applied at once,
+// turn-ons one channel at a time in restore order, each followed by the settle time of its channel so the inrush
+// of a load has faded before the next one is switched and before the battery voltage is judged again.
+class RelaisSwitcher {
+    public:
+
+        RelaisSwitcher();
+
+        ~RelaisSwitcher();
+
+        void begin(const int* pins);
+
+        void setTarget(uint8_t outputs);
+
+        void poll(const LoadShedder& loads, unsigned long now);
+
+        [[nodiscard]]
+        uint8_t getApplied() const;
+
+        [[nodiscard]]
+        bool isSettling() const;
+
+    private:
+
+        const int* pins;
+
+        uint8_t target;
+        uint8_t applied;
+
+        bool settling;
+        unsigned long switchedAt;
+        unsigned long settleTime;
+};
+
+#endif
@@ -0,0 +1,139 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "timebase.hpp"
+
+#include <Arduino.h>
+
+TimeBase TimeBase::instance;
+
+TimeBase* TimeBase::getInstance() {
+    return &instance;
+}
+
+TimeBase::TimeBase() {
+    lastMillis = 0;
+    rollovers = 0;
+
+    synced = false;
+    referenceUptime = 0;
+    referenceTime = 0;
+    drift = 0.0f;
+    slew = 0;
+    lastTime = 0;
+
+    baselineUptime = 0;
+    baselineCorrection = 0;
+}
+
+TimeBase::~TimeBase() = default;
+
+void TimeBase::poll() {
+    // millis() wraps every 49.7 days, the loop comes by far more often than that
+    const uint32_t current = millis();
+    if (current < lastMillis)
+        rollovers++;
+    lastMillis = current;
+}
+
+uint64_t TimeBase::getUptime() {
+    poll();
+    return (static_cast<uint64_t>(rollovers) << 32) | lastMillis;
+}
+
+uint64_t TimeBase::getTime() {
+    const uint64_t time = toTime(getUptime());
+    if (time > lastTime)
+        lastTime = time;
+    return lastTime;
+}
+
+uint64_t TimeBase::toTime(const uint64_t uptime) const {
+    if (!synced)
+        return uptime;
+
+    const auto elapsed = static_cast<int64_t>(uptime - referenceUptime);
+    return referenceTime + elapsed + static_cast<int64_t>(static_cast<float>(elapsed) * drift) + getSlewed(elapsed);
+}
+
+uint64_t TimeBase::expand(const uint32_t millis) {
+    // A millis() reading taken within the last rollover period
+    const uint64_t now = getUptime();
+    return now - static_cast<uint32_t>(lastMillis - millis);
+}
+
+bool TimeBase::correct(const int64_t offset, const uint64_t uptime) {
+    const uint64_t current = toTime(uptime);
+    if (current + offset < TIMEBASE_EPOCH_MIN)
+        return false;
+
+    const bool step = !synced || offset > TIMEBASE_STEP_THRESHOLD || offset < -TIMEBASE_STEP_THRESHOLD;
+
+    if (!step) {
+        // The offset still includes what is left of the previous slew, only the rest is new error.
+        // The corrections summed over the baseline are what the drift rate still misses.
+        baselineCorrection += offset - (slew - getSlewed(static_cast<int64_t>(uptime - referenceUptime)));
+        const uint64_t elapsed = uptime - baselineUptime;
+        if (elapsed >= TIMEBASE_DRIFT_BASELINE) {
+            drift += static_cast<float>(baselineCorrection) / static_cast<float>(elapsed);
+            if (drift > TIMEBASE_DRIFT_MAX)
+                drift = TIMEBASE_DRIFT_MAX;
+            else if (drift < -TIMEBASE_DRIFT_MAX)
+                drift = -TIMEBASE_DRIFT_MAX;
+
+            baselineUptime = uptime;
+            baselineCorrection = 0;
+        }
+
+        referenceTime = current;
+        slew = offset;
+    } else {
+        baselineUptime = uptime;
+        baselineCorrection = 0;
+
+        referenceTime = current + offset;
+        slew = 0;
+    }
+
+    referenceUptime = uptime;
+    synced = true;
+    return true;
+}
+
+bool TimeBase::isSynced() const {
+    return synced;
+}
+
+float TimeBase::getDrift() const {
+    return drift;
+}
+
+int64_t TimeBase::getSlewed(const int64_t elapsed) const {
+    // The part of the pending correction absorbed after elapsed milliseconds, the rate stays well below one so
+    // even a negative correction only slows the clock down
+    if (slew == 0 || elapsed <= 0)
+        return 0;
+
+    const auto slewed = static_cast<int64_t>(static_cast<float>(elapsed) * TIMEBASE_SLEW_RATE);
+    if (slew > 0)
+        return slewed < slew ? slewed : slew;
+    return slewed < -slew ? -slewed : slew;
+}
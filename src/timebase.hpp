@@ -0,0 +1,92 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__TIMEBASE__H
+#define STATION_MGMT__TIMEBASE__H
+
+#include <stdint.h>
+
+// Station times are Unix milliseconds once a client has synced the clock, milliseconds since boot before that.
+// Anything older than the epoch below can only be a time since boot.
+#define TIMEBASE_EPOCH_MIN 1577836800000ULL
+#define TIMEBASE_STEP_THRESHOLD 1000
+#define TIMEBASE_DRIFT_BASELINE 600000UL
+#define TIMEBASE_DRIFT_MAX 0.01f
+#define TIMEBASE_SLEW_RATE 0.01f
+
+// Monotonic clock built on millis(), carried across its rollover, and mapped to wall time with the corrections
+// sent by TIME_SYNC. The client estimates the offset NTP style from the timestamps of each exchange and sends it
+// back with the next one. Corrections below the step threshold are slewed in at a bounded rate, and what they add
+// up to over the baseline becomes a drift rate, so the mapping follows the oscillator of the board between syncs.
+// getTime() never goes backwards: after a step back it holds until the mapping catches up.
+class TimeBase {
+    public:
+
+        static TimeBase* getInstance();
+
+        void poll();
+
+        [[nodiscard]]
+        uint64_t getUptime();
+
+        [[nodiscard]]
+        uint64_t getTime();
+
+        [[nodiscard]]
+        uint64_t toTime(uint64_t uptime) const;
+
+        [[nodiscard]]
+        uint64_t expand(uint32_t millis);
+
+        bool correct(int64_t offset, uint64_t uptime);
+
+        [[nodiscard]]
+        bool isSynced() const;
+
+        [[nodiscard]]
+        float getDrift() const;
+
+    private:
+
+        static TimeBase instance;
+
+        explicit TimeBase();
+
+        ~TimeBase();
+
+        uint32_t lastMillis;
+        uint32_t rollovers;
+
+        bool synced;
+        uint64_t referenceUptime;
+        uint64_t referenceTime;
+        float drift;
+        int64_t slew;
+        uint64_t lastTime;
+
+        uint64_t baselineUptime;
+        int64_t baselineCorrection;
+
+        [[nodiscard]]
+        int64_t getSlewed(int64_t elapsed) const;
+};
+
+#endif
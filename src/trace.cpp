@@ -0,0 +1,191 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "trace.hpp"
+
+#include <Arduino.h>
+#include <string.h>
+
+#include "utils.hpp"
+#include "version.hpp"
+
+#ifdef TRACE_ENABLED
+Trace Trace::instance;
+
+Trace* Trace::getInstance() {
+    return &instance;
+}
+
+Trace::Trace() {
+    frameSize = 0;
+    #ifdef TRACE_TO_SD
+    device = nullptr;
+    blockUsed = 0;
+    blockPending = false;
+    framePending = false;
+    #endif
+    droppedRecords = 0;
+}
+
+Trace::~Trace() = default;
+
+bool Trace::begin(BlockDevice* blockDevice) {
+    #ifdef TRACE_TO_SD
+    device = blockDevice;
+    return device != nullptr;
+    #else
+    (void) blockDevice;
+    return true;
+    #endif
+}
+
+void Trace::recordBoot(const uint8_t resetCause) {
+    if (!open(TraceRecord::Boot))
+        return;
+
+    frameSize += packValue(frame + frameSize, static_cast<uint8_t>(TRACE_VERSION));
+    frameSize += packValue(frame + frameSize, resetCause);
+
+    const size_t versionSize = strlen(FIRMWARE_VERSION);
+    memcpy(frame + frameSize, FIRMWARE_VERSION, versionSize);
+    frameSize += versionSize;
+    close();
+}
+
+void Trace::recordDatagram(const IPAddress& ip, const uint16_t port, const char* data, size_t size) {
+    if (size > NETWORK_BUFFER_SIZE)
+        size = NETWORK_BUFFER_SIZE;
+
+    if (!open(TraceRecord::Datagram))
+        return;
+
+    for (uint8_t i = 0; i < 4; i++)
+        frameSize += packValue(frame + frameSize, static_cast<uint8_t>(ip[i]));
+    frameSize += packValue(frame + frameSize, port);
+    memcpy(frame + frameSize, data, size);
+    frameSize += size;
+    close();
+}
+
+void Trace::recordModbus(const uint16_t address, const uint8_t result, const uint16_t* registers, uint8_t count) {
+    if (count > TRACE_MODBUS_MAX_REGISTERS)
+        count = TRACE_MODBUS_MAX_REGISTERS;
+
+    if (!open(TraceRecord::Modbus))
+        return;
+
+    frameSize += packValue(frame + frameSize, address);
+    frameSize += packValue(frame + frameSize, result);
+    frameSize += packValue(frame + frameSize, count);
+    for (uint8_t i = 0; i < count; i++)
+        frameSize += packValue(frame + frameSize, registers[i]);
+    close();
+}
+
+void Trace::recordSensor(
+    const uint8_t id,
+    const SensorType type,
+    uint8_t count,
+    const SensorQuantity* quantities,
+    const float* values) {
+    if (count > SENSORS_MAX_CHANNELS)
+        count = SENSORS_MAX_CHANNELS;
+
+    if (!open(TraceRecord::Sensor))
+        return;
+
+    frameSize += packValue(frame + frameSize, id);
+    frameSize += packValue(frame + frameSize, type);
+    frameSize += packValue(frame + frameSize, count);
+    for (uint8_t channel = 0; channel < count; channel++) {
+        frameSize += packValue(frame + frameSize, quantities[channel]);
+        frameSize += packValue(frame + frameSize, values[channel]);
+    }
+    close();
+}
+
+void Trace::flush() {
+    #ifdef TRACE_TO_SD
+    if (!blockPending)
+        return;
+
+    if (!device->appendBlock(TRACE_FILE, block))
+        droppedRecords++;
+
+    blockUsed = 0;
+    blockPending = false;
+
+    if (framePending) {
+        framePending = false;
+        memcpy(block, frame, frameSize);
+        blockUsed = frameSize;
+    }
+    #endif
+}
+
+uint16_t Trace::getDroppedRecords() const {
+    return droppedRecords;
+}
+
+bool Trace::open(const TraceRecord type) {
+    #ifdef TRACE_TO_SD
+    // A frame parked behind a sealed block owns the frame buffer until the block is written
+    if (device == nullptr || framePending) {
+        droppedRecords++;
+        return false;
+    }
+    #endif
+
+    frameSize = 0;
+    frameSize += packValue(frame + frameSize, static_cast<uint16_t>(TRACE_SYNC));
+    frameSize += packValue(frame + frameSize, type);
+    frameSize += packValue(frame + frameSize, static_cast<uint8_t>(0x00));
+    frameSize += packValue(frame + frameSize, static_cast<uint32_t>(millis()));
+    return true;
+}
+
+void Trace::close() {
+    frame[3] = static_cast<char>(frameSize - TRACE_HEADER_SIZE);
+
+    const uint16_t crc = crc16(reinterpret_cast<const uint8_t*>(frame + 2), frameSize - 2);
+    frameSize += packValue(frame + frameSize, crc);
+
+    #ifdef TRACE_TO_SD
+    // Frames never straddle blocks: the tail is zero padded, which the decoder skips while resyncing
+    if (blockPending || blockUsed + frameSize > BLOCK_DEVICE_BLOCK_SIZE) {
+        if (!blockPending) {
+            memset(block + blockUsed, 0, BLOCK_DEVICE_BLOCK_SIZE - blockUsed);
+            blockPending = true;
+        }
+        framePending = true;
+        return;
+    }
+
+    memcpy(block + blockUsed, frame, frameSize);
+    blockUsed += frameSize;
+    if (blockUsed == BLOCK_DEVICE_BLOCK_SIZE)
+        blockPending = true;
+    #else
+    // Serial.write() blocks once the 64 byte TX ring is full, a frame costs up to 7 ms at 115200 baud
+    Serial.write(reinterpret_cast<const uint8_t*>(frame), frameSize);
+    #endif
+}
+#endif
@@ -0,0 +1,104 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__TRACE__H
+#define STATION_MGMT__TRACE__H
+
+#include <IPAddress.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "blockdev.hpp"
+#include "const.hpp"
+#include "sensors.hpp"
+
+// Frame: sync, type, payload length, timestamp, payload, CRC16 of everything after the sync.
+// The replayer in tools/replay decodes it, keep both sides in step when a record changes.
+#define TRACE_SYNC 0xA55A
+#define TRACE_VERSION 0x01
+#define TRACE_HEADER_SIZE 8
+#define TRACE_CRC_SIZE 2
+#define TRACE_PAYLOAD_MAX_SIZE (NETWORK_BUFFER_SIZE + 6)
+#define TRACE_FRAME_MAX_SIZE (TRACE_HEADER_SIZE + TRACE_PAYLOAD_MAX_SIZE + TRACE_CRC_SIZE)
+#define TRACE_MODBUS_MAX_REGISTERS 20
+
+#if defined(TRACE_TO_SD) && !defined(SD_LOGGER_ENABLED)
+    #error "TRACE_TO_SD writes through the SD logger block device"
+#endif
+
+// Far above any day index of the SD logger, Unix days of station time included
+#define TRACE_FILE 60000
+
+enum class TraceRecord : uint8_t {
+    Boot = 0x01,        // version, reset cause, firmware version
+    Datagram = 0x02,    // address, port, request
+    Modbus = 0x03,      // start register, result, count, registers
+    Sensor = 0x04       // id, type, count, (quantity, value) per channel
+};
+
+class Trace {
+    public:
+
+        static Trace* getInstance();
+
+        bool begin(BlockDevice* blockDevice);
+
+        void recordBoot(uint8_t resetCause);
+
+        void recordDatagram(const IPAddress& ip, uint16_t port, const char* data, size_t size);
+
+        void recordModbus(uint16_t address, uint8_t result, const uint16_t* registers, uint8_t count);
+
+        void recordSensor(uint8_t id, SensorType type, uint8_t count, const SensorQuantity* quantities, const float* values);
+
+        void flush();
+
+        [[nodiscard]]
+        uint16_t getDroppedRecords() const;
+
+    private:
+
+        static Trace instance;
+
+        explicit Trace();
+
+        ~Trace();
+
+        char frame[TRACE_FRAME_MAX_SIZE];
+        size_t frameSize;
+
+#ifdef TRACE_TO_SD
+        BlockDevice* device;
+
+        uint8_t block[BLOCK_DEVICE_BLOCK_SIZE];
+        uint16_t blockUsed;
+        bool blockPending;
+        bool framePending;
+#endif
+
+        uint16_t droppedRecords;
+
+        bool open(TraceRecord type);
+
+        void close();
+};
+
+#endif
@@ -22,26 +22,25 @@
 #include "utils.hpp"
 
 #include <stdint.h>
-#include <stdio.h>
-#include <string.h>
+
+#include "benchmark.hpp"
 
 void swapEndianness(void* var, const size_t size) {
-    uint8_t tmp[size];
-    memcpy(tmp, var, size);
-    auto* dst = static_cast<uint8_t*>(var);
-    for (size_t i = 0; i < size; i++)
-        dst[size - i - 1] = tmp[i];
+    benchmarkBegin(SwapEndianness);
+    auto* data = static_cast<uint8_t*>(var);
+    for (size_t i = 0; i < size / 2; i++) {
+        const uint8_t tmp = data[i];
+        data[i] = data[size - i - 1];
+        data[size - i - 1] = tmp;
+    }
+    benchmarkEnd(SwapEndianness);
 }
 
-void payloadToHex(char* dest, const char* payload, const size_t& size) {
-    char* output = dest;
+uint16_t crc16(const uint8_t* data, const size_t size, uint16_t crc) {
     for (size_t i = 0; i < size; i++) {
-        if (i > 0) {
-            *output = ' ';
-            output += 1;
-        }
-        sprintf(output, "%02x", static_cast<unsigned char>(payload[i]));
-        output += 2;
+        crc ^= static_cast<uint16_t>(data[i]) << 8;
+        for (uint8_t bit = 0; bit < 8; bit++)
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
     }
-    *output = '\0';
+    return crc;
 }
@@ -23,10 +23,18 @@
 #define STATION_MGMT__UTILS__H
 
 #include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 
 void swapEndianness(void* var, size_t size);
 
-void payloadToHex(char* dest, const char* payload, const size_t& size);
+uint16_t crc16(const uint8_t* data, size_t size, uint16_t crc = 0xFFFF);
 
+template <typename T>
+size_t packValue(char* dest, T value) {
+    swapEndianness(&value, sizeof(T));
+    memcpy(dest, &value, sizeof(T));
+    return sizeof(T);
+}
 
 #endif
@@ -0,0 +1,117 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <host.hpp>
+#include <unity.h>
+#include <string.h>
+
+#include "events.hpp"
+
+struct BufferWriter {
+        uint8_t data[256];
+        size_t size = 0;
+
+        template <typename T>
+        size_t writeValue(const T& value) {
+            memcpy(data + size, &value, sizeof(T));
+            size += sizeof(T);
+            return sizeof(T);
+        }
+};
+
+static const IPAddress receiverIp(192, 168, 1, 10);
+static uint16_t receiverPort = 4000;
+
+void setUp() {
+    // Receivers are never reset, every test subscribes from a new port
+    receiverPort++;
+}
+
+void tearDown() {
+    Events::getInstance()->unsubscribe(receiverIp, receiverPort);
+}
+
+static void drain(Events* events) {
+    while (events->nextPendingReceiver(millis()) != nullptr)
+        ;
+}
+
+void test_idle_receiver_gets_next_event() {
+    Events* events = Events::getInstance();
+    drain(events);
+
+    TEST_ASSERT_TRUE(events->subscribe(receiverIp, receiverPort) != EVENTS_RECEIVER_NONE);
+
+    hostAdvanceMicros((EVENTS_RECEIVER_TIMEOUT + 1000) * 1000ULL);
+    events->publish(EventCode::Modbus, 0, 1);
+
+    EventReceiver* receiver = events->nextPendingReceiver(millis());
+    TEST_ASSERT_NOT_NULL(receiver);
+    TEST_ASSERT_EQUAL_UINT16(receiverPort, receiver->port);
+
+    BufferWriter writer;
+    events->serialize(receiver, writer, millis());
+    TEST_ASSERT_EQUAL_UINT8(1, writer.data[0]);
+}
+
+void test_unacked_receiver_times_out() {
+    Events* events = Events::getInstance();
+    drain(events);
+
+    TEST_ASSERT_TRUE(events->subscribe(receiverIp, receiverPort) != EVENTS_RECEIVER_NONE);
+    events->publish(EventCode::Modbus, 0, 2);
+
+    hostAdvanceMicros((EVENTS_RECEIVER_TIMEOUT + 1000) * 1000ULL);
+    TEST_ASSERT_NULL(events->nextPendingReceiver(millis()));
+
+    // Deactivated, so a further event is not delivered either
+    events->publish(EventCode::Modbus, 0, 3);
+    TEST_ASSERT_NULL(events->nextPendingReceiver(millis()));
+}
+
+void test_repeated_acknowledge_keeps_receiver() {
+    Events* events = Events::getInstance();
+    drain(events);
+
+    TEST_ASSERT_TRUE(events->subscribe(receiverIp, receiverPort) != EVENTS_RECEIVER_NONE);
+    events->publish(EventCode::Modbus, 0, 4);
+    events->acknowledge(receiverIp, receiverPort, events->getLastSequence());
+
+    // The current sequence again, after most of the timeout
+    hostAdvanceMicros((EVENTS_RECEIVER_TIMEOUT - 1000) * 1000ULL);
+    events->acknowledge(receiverIp, receiverPort, events->getLastSequence());
+
+    hostAdvanceMicros(2000 * 1000ULL);
+    events->publish(EventCode::Modbus, 0, 5);
+    hostAdvanceMicros((EVENTS_RECEIVER_TIMEOUT - 1000) * 1000ULL);
+
+    EventReceiver* receiver = events->nextPendingReceiver(millis());
+    TEST_ASSERT_NOT_NULL(receiver);
+    TEST_ASSERT_EQUAL_UINT16(receiverPort, receiver->port);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_idle_receiver_gets_next_event);
+    RUN_TEST(test_unacked_receiver_times_out);
+    RUN_TEST(test_repeated_acknowledge_keeps_receiver);
+    return UNITY_END();
+}
@@ -0,0 +1,67 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <EEPROM.h>
+#include <host.hpp>
+#include <unity.h>
+
+#include "eeprom.hpp"
+#include "log.hpp"
+
+// Records of the first layout: sequence, code, param, value and a 32 bit timestamp, with no layout byte
+#define TEST_LEGACY_RECORD_SIZE 9
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_legacy_log_starts_over_empty() {
+    EEPROM.write(EEPROM_ADDRESS_LOG_LAYOUT, 0xFF);
+
+    uint16_t sequence = 0;
+    for (int address = EEPROM_ADDRESS_LOG_START; address + TEST_LEGACY_RECORD_SIZE <= EEPROM_ADDRESS_LOG_END;
+         address += TEST_LEGACY_RECORD_SIZE) {
+        EEPROM.write(address, sequence & 0xFF);
+        EEPROM.write(address + 1, sequence >> 8);
+        for (uint8_t i = 2; i < TEST_LEGACY_RECORD_SIZE; i++)
+            EEPROM.write(address + i, 0x5A);
+        sequence++;
+    }
+
+    EventLog* eventLog = EventLog::getInstance();
+    eventLog->begin();
+    TEST_ASSERT_EQUAL_UINT16(0, eventLog->getCount());
+
+    eventLog->append(EventCode::Modbus, 0, 1, 1000);
+    eventLog->flush();
+
+    // The next boot finds the single record written since
+    eventLog->begin();
+    TEST_ASSERT_EQUAL_UINT16(1, eventLog->getCount());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_legacy_log_starts_over_empty);
+    return UNITY_END();
+}
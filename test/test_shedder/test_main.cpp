@@ -0,0 +1,165 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <EEPROM.h>
+#include <host.hpp>
+#include <string.h>
+#include <unity.h>
+
+#include "eeprom.hpp"
+#include "shedder.hpp"
+#include "utils.hpp"
+
+#define TEST_VOLTAGE_LOW 11.5f
+#define TEST_VOLTAGE_HIGH 13.0f
+
+static LoadShedder* shedder;
+
+static void configure(const uint8_t channel, const uint8_t priority) {
+    TEST_ASSERT_TRUE(shedder->setSettings(channel, {priority, 12.0f, 12.6f, SHEDDER_SETTLE_TIME_DEFAULT}));
+}
+
+void setUp() {
+    // Settings persist in EEPROM, every test starts from a table of unmanaged channels
+    shedder = new LoadShedder();
+    for (uint8_t i = 0; i < RELAIS_NUMBER; i++)
+        TEST_ASSERT_TRUE(shedder->setSettings(i, {0, 0.0f, 0.0f, SHEDDER_SETTLE_TIME_DEFAULT}));
+}
+
+void tearDown() {
+    delete shedder;
+}
+
+void test_sheds_by_priority_and_restores_in_reverse() {
+    configure(0, 2);
+    configure(1, 1);
+    configure(2, 3);
+
+    TEST_ASSERT_EQUAL_HEX8(0xFD, shedder->evaluate(TEST_VOLTAGE_LOW, 0xFF, 1000));
+    TEST_ASSERT_EQUAL_HEX8(0xFC, shedder->evaluate(TEST_VOLTAGE_LOW, 0xFF, 2000));
+    TEST_ASSERT_EQUAL_HEX8(0xF8, shedder->evaluate(TEST_VOLTAGE_LOW, 0xFF, 3000));
+    TEST_ASSERT_EQUAL_HEX8(0xF8, shedder->evaluate(TEST_VOLTAGE_LOW, 0xFF, 4000));
+
+    // Between the thresholds nothing moves
+    TEST_ASSERT_EQUAL_HEX8(0xF8, shedder->evaluate(12.3f, 0xFF, 5000));
+
+    TEST_ASSERT_EQUAL_HEX8(0xFC, shedder->evaluate(TEST_VOLTAGE_HIGH, 0xFF, 6000));
+    TEST_ASSERT_EQUAL_HEX8(0xFD, shedder->evaluate(TEST_VOLTAGE_HIGH, 0xFF, 7000));
+    TEST_ASSERT_EQUAL_HEX8(0xFF, shedder->evaluate(TEST_VOLTAGE_HIGH, 0xFF, 8000));
+}
+
+void test_ties_shed_the_lower_channel_first() {
+    configure(3, 1);
+    configure(4, 1);
+
+    TEST_ASSERT_EQUAL_HEX8(0xF7, shedder->evaluate(TEST_VOLTAGE_LOW, 0xFF, 1000));
+    TEST_ASSERT_EQUAL_HEX8(0xE7, shedder->evaluate(TEST_VOLTAGE_LOW, 0xFF, 2000));
+
+    TEST_ASSERT_EQUAL_HEX8(0xF7, shedder->evaluate(TEST_VOLTAGE_HIGH, 0xFF, 3000));
+    TEST_ASSERT_EQUAL_HEX8(0xFF, shedder->evaluate(TEST_VOLTAGE_HIGH, 0xFF, 4000));
+}
+
+void test_disabled_channel_does_not_hold_the_order() {
+    configure(0, 1);
+    configure(1, 2);
+
+    // Channel 0 is off by hand, so channel 1 goes in the same pass
+    TEST_ASSERT_EQUAL_HEX8(0xFC, shedder->evaluate(TEST_VOLTAGE_LOW, 0xFE, 1000));
+}
+
+void test_dwell_times_hold_changes() {
+    configure(5, 1);
+    shedder->setDwellTimes(10, 20);
+
+    TEST_ASSERT_EQUAL_HEX8(0xDF, shedder->evaluate(TEST_VOLTAGE_LOW, 0xFF, 1000));
+
+    // Off for at least 20 s before it comes back
+    TEST_ASSERT_EQUAL_HEX8(0xDF, shedder->evaluate(TEST_VOLTAGE_HIGH, 0xFF, 20999));
+    TEST_ASSERT_EQUAL_HEX8(0xFF, shedder->evaluate(TEST_VOLTAGE_HIGH, 0xFF, 21000));
+
+    // Then on for at least 10 s before it is shed again
+    TEST_ASSERT_EQUAL_HEX8(0xFF, shedder->evaluate(TEST_VOLTAGE_LOW, 0xFF, 30999));
+    TEST_ASSERT_EQUAL_HEX8(0xDF, shedder->evaluate(TEST_VOLTAGE_LOW, 0xFF, 31000));
+}
+
+void test_settings_survive_a_restart() {
+    configure(6, 4);
+    TEST_ASSERT_TRUE(shedder->setSettings(7, {3, 11.8f, 12.4f, 2000}));
+
+    delete shedder;
+    shedder = new LoadShedder();
+
+    const LoadSettings& settings = shedder->getSettings(7);
+    TEST_ASSERT_EQUAL_UINT8(3, settings.priority);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 11.8f, settings.offVoltage);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 12.4f, settings.onVoltage);
+    TEST_ASSERT_EQUAL_UINT16(2000, settings.settleTime);
+    TEST_ASSERT_EQUAL_HEX8(1 << 6, shedder->getHigherRanked(7));
+}
+
+void test_legacy_table_is_migrated() {
+    uint8_t data[SHEDDER_LEGACY_DATA_SIZE];
+    memset(data, 0, sizeof(data));
+    const float offVoltage = 11.9f;
+    const float onVoltage = 12.5f;
+    uint8_t* entry = data + 2 * SHEDDER_LEGACY_ENTRY_SIZE;
+    entry[0] = 5;
+    memcpy(entry + 1, &offVoltage, sizeof(float));
+    memcpy(entry + 5, &onVoltage, sizeof(float));
+
+    const uint16_t magic = SHEDDER_LEGACY_MAGIC;
+    const uint16_t crc = crc16(data, SHEDDER_LEGACY_DATA_SIZE);
+    uint8_t header[SHEDDER_HEADER_SIZE];
+    memcpy(header, &magic, sizeof(uint16_t));
+    memcpy(header + 2, &crc, sizeof(uint16_t));
+    for (uint8_t i = 0; i < SHEDDER_HEADER_SIZE; i++)
+        EEPROM.write(EEPROM_ADDRESS_SHEDDER + i, header[i]);
+    for (uint8_t i = 0; i < SHEDDER_LEGACY_DATA_SIZE; i++)
+        EEPROM.write(EEPROM_ADDRESS_SHEDDER + SHEDDER_HEADER_SIZE + i, data[i]);
+
+    delete shedder;
+    shedder = new LoadShedder();
+
+    const LoadSettings& settings = shedder->getSettings(2);
+    TEST_ASSERT_EQUAL_UINT8(5, settings.priority);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 11.9f, settings.offVoltage);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 12.5f, settings.onVoltage);
+    TEST_ASSERT_EQUAL_UINT16(SHEDDER_SETTLE_TIME_DEFAULT, settings.settleTime);
+
+    // Written back in the current layout
+    const uint16_t storedMagic = EEPROM.read(EEPROM_ADDRESS_SHEDDER) | EEPROM.read(EEPROM_ADDRESS_SHEDDER + 1) << 8;
+    TEST_ASSERT_EQUAL_HEX16(SHEDDER_MAGIC, storedMagic);
+
+    delete shedder;
+    shedder = new LoadShedder();
+    TEST_ASSERT_EQUAL_UINT8(5, shedder->getSettings(2).priority);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_sheds_by_priority_and_restores_in_reverse);
+    RUN_TEST(test_ties_shed_the_lower_channel_first);
+    RUN_TEST(test_disabled_channel_does_not_hold_the_order);
+    RUN_TEST(test_dwell_times_hold_changes);
+    RUN_TEST(test_settings_survive_a_restart);
+    RUN_TEST(test_legacy_table_is_migrated);
+    return UNITY_END();
+}
@@ -0,0 +1,79 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <unity.h>
+
+#include "stats.hpp"
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+static void pushSample(Statistics& statistics, const unsigned long timestamp) {
+    // Panel power and charge current vary from one sample to the next
+    const float panelCurrent = 1.0f + static_cast<float>(timestamp % 7000) / 1000.0f;
+    statistics.push(timestamp, 12.8f, panelCurrent / 2.0f, 18.0f, panelCurrent);
+}
+
+void test_reset_keeps_energy_between_epochs() {
+    Statistics continuous;
+    Statistics resetting;
+
+    float energyBefore = 0;
+    float chargeBefore = 0;
+    for (unsigned long timestamp = 1000; timestamp <= 120000; timestamp += 1000) {
+        pushSample(continuous, timestamp);
+        pushSample(resetting, timestamp);
+
+        // Halfway between two samples, the way STATS_RESET comes in
+        if (timestamp == 60000) {
+            energyBefore = resetting.getEnergyHarvested();
+            chargeBefore = resetting.getChargeAccumulated();
+            resetting.reset(timestamp + 500);
+        }
+    }
+
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, continuous.getEnergyHarvested(), energyBefore + resetting.getEnergyHarvested());
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, continuous.getChargeAccumulated(), chargeBefore + resetting.getChargeAccumulated());
+    TEST_ASSERT_EQUAL_UINT32(60, resetting.getSamples());
+}
+
+void test_reset_seeds_extremes_from_next_sample() {
+    Statistics statistics;
+    statistics.push(1000, 12.0f, 1.0f, 18.0f, 1.0f);
+    statistics.push(2000, 13.0f, 1.0f, 18.0f, 2.0f);
+    statistics.reset(2500);
+
+    statistics.push(3000, 12.5f, 1.0f, 18.0f, 1.5f);
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, 12.5f, statistics.getBatteryVoltageMin());
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, 12.5f, statistics.getBatteryVoltageMax());
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, 27.0f, statistics.getPanelPowerMin());
+    TEST_ASSERT_EQUAL_UINT16(2, statistics.getEpoch());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_reset_keeps_energy_between_epochs);
+    RUN_TEST(test_reset_seeds_extremes_from_next_sample);
+    return UNITY_END();
+}
@@ -0,0 +1,84 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <ModbusMaster.h>
+#include <host.hpp>
+#include <unity.h>
+
+#include "filter.hpp"
+
+void setup();
+
+void loop();
+
+extern float batteryVoltage;
+extern float batteryVoltageFiltered;
+extern VoltageFilter batteryVoltageFilter;
+
+#define TEST_BATTERY_VOLTAGE 1280
+
+static bool failReads = false;
+
+static void run(const uint32_t ms) {
+    for (uint32_t elapsed = 0; elapsed < ms; elapsed += 50) {
+        hostAdvanceMicros(50000);
+        loop();
+    }
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_failed_read_keeps_filtered_voltage() {
+    hostSetModbusHook([](const uint16_t address, const uint16_t count, uint16_t* registers) -> uint8_t {
+        if (failReads)
+            return ModbusMaster::ku8MBResponseTimedOut;
+
+        for (uint16_t i = 0; i < count; i++)
+            registers[i] = address + i == 0x3104 ? TEST_BATTERY_VOLTAGE : 0;
+        return ModbusMaster::ku8MBSuccess;
+    });
+
+    setup();
+    // No median, so a single sample would show straight away
+    batteryVoltageFilter.setMedianSize(1);
+
+    run(10000);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 12.8f, batteryVoltageFiltered);
+
+    failReads = true;
+    run(1100);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, batteryVoltage);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 12.8f, batteryVoltageFiltered);
+
+    failReads = false;
+    run(5000);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 12.8f, batteryVoltageFiltered);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_failed_read_keeps_filtered_voltage);
+    return UNITY_END();
+}
@@ -0,0 +1,135 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <host.hpp>
+#include <unity.h>
+
+#include "timebase.hpp"
+
+// New Year 2024, well past the epoch minimum
+#define TEST_TIME 1704067200000ULL
+
+static void advance(const uint64_t ms) {
+    hostAdvanceMicros(ms * 1000ULL);
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+// The steps below share the one TimeBase instance and run in order
+
+void test_expand_across_rollover() {
+    TimeBase* timeBase = TimeBase::getInstance();
+
+    advance(0x100000000ULL - timeBase->getUptime() - 1000);
+    const uint32_t before = millis();
+    TEST_ASSERT_EQUAL_UINT64(0x100000000ULL - 1000, timeBase->getUptime());
+
+    advance(2000);
+    TEST_ASSERT_EQUAL_UINT64(0x100000000ULL + 1000, timeBase->getUptime());
+    TEST_ASSERT_EQUAL_UINT64(0x100000000ULL - 1000, timeBase->expand(before));
+    TEST_ASSERT_EQUAL_UINT64(0x100000000ULL + 1000, timeBase->expand(millis()));
+
+    // Unsynced, station time is the uptime
+    TEST_ASSERT_EQUAL_UINT64(timeBase->getUptime(), timeBase->getTime());
+}
+
+void test_first_sync_steps() {
+    TimeBase* timeBase = TimeBase::getInstance();
+
+    const uint64_t uptime = timeBase->getUptime();
+    TEST_ASSERT_FALSE(timeBase->correct(1000, uptime));
+    TEST_ASSERT_TRUE(timeBase->correct(static_cast<int64_t>(TEST_TIME - uptime), uptime));
+    TEST_ASSERT_TRUE(timeBase->isSynced());
+    TEST_ASSERT_EQUAL_UINT64(TEST_TIME, timeBase->getTime());
+
+    advance(500);
+    TEST_ASSERT_EQUAL_UINT64(TEST_TIME + 500, timeBase->getTime());
+}
+
+void test_large_offset_steps() {
+    TimeBase* timeBase = TimeBase::getInstance();
+
+    const uint64_t before = timeBase->getTime();
+    TEST_ASSERT_TRUE(timeBase->correct(TIMEBASE_STEP_THRESHOLD + 4000, timeBase->getUptime()));
+    TEST_ASSERT_EQUAL_UINT64(before + TIMEBASE_STEP_THRESHOLD + 4000, timeBase->getTime());
+}
+
+void test_small_offset_slews() {
+    TimeBase* timeBase = TimeBase::getInstance();
+
+    const uint64_t before = timeBase->getTime();
+    TEST_ASSERT_TRUE(timeBase->correct(400, timeBase->getUptime()));
+    TEST_ASSERT_EQUAL_UINT64(before, timeBase->getTime());
+
+    // Ahead of the plain clock by the slew rate until the offset is absorbed
+    advance(10000);
+    TEST_ASSERT_EQUAL_UINT64(before + 10000 + 100, timeBase->getTime());
+
+    advance(60000);
+    TEST_ASSERT_EQUAL_UINT64(before + 70000 + 400, timeBase->getTime());
+}
+
+void test_negative_offset_never_goes_back() {
+    TimeBase* timeBase = TimeBase::getInstance();
+
+    const uint64_t before = timeBase->getTime();
+    TEST_ASSERT_TRUE(timeBase->correct(-TIMEBASE_STEP_THRESHOLD, timeBase->getUptime()));
+
+    uint64_t last = timeBase->getTime();
+    TEST_ASSERT_EQUAL_UINT64(before, last);
+    for (uint16_t i = 0; i < 1500; i++) {
+        advance(100);
+        const uint64_t time = timeBase->getTime();
+        TEST_ASSERT_GREATER_OR_EQUAL_UINT64(last, time);
+        last = time;
+    }
+
+    TEST_ASSERT_EQUAL_UINT64(before + 150000 - TIMEBASE_STEP_THRESHOLD, last);
+}
+
+void test_step_back_holds() {
+    TimeBase* timeBase = TimeBase::getInstance();
+
+    const uint64_t before = timeBase->getTime();
+    TEST_ASSERT_TRUE(timeBase->correct(-5000, timeBase->getUptime()));
+    TEST_ASSERT_EQUAL_UINT64(before, timeBase->getTime());
+
+    advance(4000);
+    TEST_ASSERT_EQUAL_UINT64(before, timeBase->getTime());
+
+    advance(2000);
+    TEST_ASSERT_EQUAL_UINT64(before + 1000, timeBase->getTime());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_expand_across_rollover);
+    RUN_TEST(test_first_sync_steps);
+    RUN_TEST(test_large_offset_steps);
+    RUN_TEST(test_small_offset_slews);
+    RUN_TEST(test_negative_offset_never_goes_back);
+    RUN_TEST(test_step_back_holds);
+    return UNITY_END();
+}
@@ -0,0 +1,207 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "client.hpp"
+
+#define BENCH_DEFAULT_COUNT 1000
+#define BENCH_DEFAULT_OPCODES "tsm"
+
+using Clock = std::chrono::steady_clock;
+
+struct Results {
+    std::vector<double> latencies;
+    size_t nacks = 0;
+    size_t timeouts = 0;
+    size_t malformed = 0;
+};
+
+template <typename R>
+static void submitTimed(StationClient& client, const R& request, Results& results) {
+    const Clock::time_point start = Clock::now();
+    client.submit(request, [&results, start](const ClientResult<typename R::Response>& result) {
+        switch (result.error) {
+            case ClientError::None:
+                results.latencies.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+                break;
+            case ClientError::Nack:
+                results.nacks++;
+                break;
+            case ClientError::Timeout:
+                results.timeouts++;
+                break;
+            default:
+                results.malformed++;
+        }
+    });
+}
+
+static bool submitOpcode(StationClient& client, const char opcode, Results& results) {
+    switch (opcode) {
+        case PROTOCOL_PING:
+            submitTimed(client, PingRequest{}, results);
+            return true;
+        case PROTOCOL_TELEMETRY:
+            submitTimed(client, TelemetryRequest{}, results);
+            return true;
+        case PROTOCOL_STATUS:
+            submitTimed(client, StatusRequest{}, results);
+            return true;
+        case PROTOCOL_METEO:
+            submitTimed(client, MeteoRequest{}, results);
+            return true;
+        case PROTOCOL_SENSORS_READ:
+            submitTimed(client, SensorsRequest{}, results);
+            return true;
+        case PROTOCOL_DIAGNOSTICS:
+            submitTimed(client, DiagnosticsRequest{}, results);
+            return true;
+        case PROTOCOL_STATS_READ:
+            submitTimed(client, StatisticsRequest{}, results);
+            return true;
+        case PROTOCOL_LOADS_READ:
+            submitTimed(client, LoadsRequest{}, results);
+            return true;
+        case PROTOCOL_CONTROLLER_READ:
+            submitTimed(client, ControllerRequest{}, results);
+            return true;
+        case PROTOCOL_ENERGY_READ:
+            submitTimed(client, EnergyRequest{}, results);
+            return true;
+        default:
+            return false;
+    }
+}
+
+static double percentile(const std::vector<double>& sorted, const double fraction) {
+    if (sorted.empty())
+        return 0;
+
+    return sorted[std::min(sorted.size() - 1, static_cast<size_t>(fraction * sorted.size()))];
+}
+
+static void usage(const char* name) {
+    fprintf(stderr, "Usage: %s [-n count] [-w window] [-c opcodes] [-t timeout_ms] [-r retries] [-k] host[:port]\n", name);
+}
+
+int main(int argc, char** argv) {
+    size_t count = BENCH_DEFAULT_COUNT;
+    size_t window = CLIENT_DEFAULT_WINDOW;
+    std::string opcodes = BENCH_DEFAULT_OPCODES;
+    uint32_t timeout = 0;
+    uint8_t retries = CLIENT_DEFAULT_RETRIES;
+    bool coalescing = false;
+
+    int option;
+    while ((option = getopt(argc, argv, "n:w:c:t:r:kh")) != -1) {
+        switch (option) {
+            case 'n':
+                count = strtoul(optarg, nullptr, 0);
+                break;
+            case 'w':
+                window = strtoul(optarg, nullptr, 0);
+                break;
+            case 'c':
+                opcodes = optarg;
+                break;
+            case 't':
+                timeout = strtoul(optarg, nullptr, 0);
+                break;
+            case 'r':
+                retries = strtoul(optarg, nullptr, 0);
+                break;
+            case 'k':
+                coalescing = true;
+                break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+
+    if (optind != argc - 1 || opcodes.empty()) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    // The last request of a full window is served that many station intervals after the first one
+    if (timeout == 0)
+        timeout = CLIENT_DEFAULT_TIMEOUT + (std::max<size_t>(window, 1) - 1) * CLIENT_STATION_INTERVAL;
+
+    std::string host = argv[optind];
+    uint16_t port = NETWORK_UDP_PORT;
+    const size_t colon = host.find(':');
+    if (colon != std::string::npos) {
+        port = strtoul(host.c_str() + colon + 1, nullptr, 0);
+        host.resize(colon);
+    }
+
+    StationClient client;
+    client.setWindow(window);
+    client.setTimeout(timeout);
+    client.setRetries(retries);
+    client.setCoalescing(coalescing);
+    if (!client.open(host.c_str(), port)) {
+        fprintf(stderr, "Cannot reach %s:%u\n", host.c_str(), port);
+        return 2;
+    }
+
+    Results results;
+    size_t submitted = 0;
+    const Clock::time_point start = Clock::now();
+
+    // Keeps the window full: each slot freed by an answer is refilled by the next opcode in the rotation
+    while (submitted < count || !client.isIdle()) {
+        while (submitted < count && client.getInFlight() < window) {
+            if (!submitOpcode(client, opcodes[submitted % opcodes.size()], results)) {
+                fprintf(stderr, "Opcode '%c' has no benchmark request\n", opcodes[submitted % opcodes.size()]);
+                return 2;
+            }
+            submitted++;
+        }
+        client.run(static_cast<int>(timeout));
+    }
+
+    const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    std::sort(results.latencies.begin(), results.latencies.end());
+
+    printf("Requests: %zu submitted, %zu answered, %zu NACK, %zu timed out, %zu malformed\n",
+           submitted, results.latencies.size(), results.nacks, results.timeouts, results.malformed);
+    printf("Datagrams: %llu sent, %llu retransmitted, %llu requests coalesced\n",
+           static_cast<unsigned long long>(client.getSent()), static_cast<unsigned long long>(client.getRetransmits()),
+           static_cast<unsigned long long>(client.getCoalesced()));
+    printf("Throughput: %.1f requests/s over %.2f s, window %zu\n",
+           elapsed > 0 ? results.latencies.size() / elapsed : 0, elapsed, window);
+    printf("Latency ms: p50 %.2f, p90 %.2f, p99 %.2f, max %.2f\n",
+           percentile(results.latencies, 0.50), percentile(results.latencies, 0.90),
+           percentile(results.latencies, 0.99), results.latencies.empty() ? 0 : results.latencies.back());
+
+    return results.timeouts > 0 || results.malformed > 0 ? 1 : 0;
+}
@@ -0,0 +1,980 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__CLIENT__CLIENT__H
+#define STATION_MGMT__CLIENT__CLIENT__H
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "const.hpp"
+#include "enums.hpp"
+#include "protocol.hpp"
+#include "sensors.hpp"
+#include "timebase.hpp"
+
+// Header-only client for the station UDP protocol. Layouts mirror doReceiveCommand() and the
+// serializers it calls, opcodes and sizes come from include/protocol.hpp.
+
+// The station takes one datagram off its socket per ReceiveCommand run, so each request queued behind another one
+// waits a further interval for its answer
+#define CLIENT_STATION_INTERVAL 250
+
+#define CLIENT_DEFAULT_TIMEOUT 1000
+#define CLIENT_DEFAULT_RETRIES 2
+#define CLIENT_DEFAULT_WINDOW 1
+#define CLIENT_DATAGRAM_SIZE 1500
+
+enum class ClientError : uint8_t {
+    None = 0x00,
+    Timeout = 0x01,
+    Nack = 0x02,
+    Malformed = 0x03,
+    Transport = 0x04
+};
+
+class WireReader {
+    public:
+
+        WireReader(const uint8_t* data, const size_t size) {
+            this->data = data;
+            this->size = size;
+            offset = 0;
+            valid = true;
+        }
+
+        template <typename T>
+        T read() {
+            T value{};
+            if (offset + sizeof(T) > size) {
+                valid = false;
+                return value;
+            }
+
+            // Big-endian on the wire, as packed by swapEndianness() on the device
+            uint8_t bytes[sizeof(T)];
+            for (size_t i = 0; i < sizeof(T); i++)
+                bytes[i] = data[offset + sizeof(T) - 1 - i];
+            memcpy(&value, bytes, sizeof(T));
+            offset += sizeof(T);
+            return value;
+        }
+
+        std::vector<uint8_t> readRemaining() {
+            std::vector<uint8_t> bytes(data + offset, data + size);
+            offset = size;
+            return bytes;
+        }
+
+        [[nodiscard]]
+        size_t getRemaining() const {
+            return size - offset;
+        }
+
+        [[nodiscard]]
+        bool isValid() const {
+            return valid;
+        }
+
+    private:
+
+        const uint8_t* data;
+        size_t size;
+        size_t offset;
+        bool valid;
+};
+
+class WireWriter {
+    public:
+
+        explicit WireWriter(std::vector<uint8_t>& out) : out(out) {}
+
+        template <typename T>
+        void write(const T value) {
+            uint8_t bytes[sizeof(T)];
+            memcpy(bytes, &value, sizeof(T));
+            for (size_t i = 0; i < sizeof(T); i++)
+                out.push_back(bytes[sizeof(T) - 1 - i]);
+        }
+
+    private:
+
+        std::vector<uint8_t>& out;
+};
+
+struct Empty {
+    void decode(WireReader&) {}
+};
+
+// Station times are Unix milliseconds once the station clock is synced, milliseconds since its boot before that
+inline bool isWallTime(const uint64_t time) {
+    return time >= TIMEBASE_EPOCH_MIN;
+}
+
+struct PingReply {
+    uint64_t time;
+
+    void decode(WireReader& reader) {
+        time = reader.read<uint64_t>();
+    }
+};
+
+struct Telemetry {
+    uint64_t timestamp;
+    float panelVoltage;
+    float panelCurrent;
+    float batteryVoltage;
+    float batteryChargeCurrent;
+    bool globalStatus;
+    float batteryVoltageFiltered;
+
+    void decode(WireReader& reader) {
+        timestamp = reader.read<uint64_t>();
+        panelVoltage = reader.read<float>();
+        panelCurrent = reader.read<float>();
+        batteryVoltage = reader.read<float>();
+        batteryChargeCurrent = reader.read<float>();
+        globalStatus = reader.read<uint8_t>() != 0;
+        batteryVoltageFiltered = reader.read<float>();
+    }
+};
+
+// Charge controller values outside the telemetry, in W, V, A and °C
+struct ControllerDetails {
+    uint64_t timestamp;
+    float panelPower;
+    float batteryChargePower;
+    float loadVoltage;
+    float loadCurrent;
+    float loadPower;
+    float batteryTemperature;
+    float deviceTemperature;
+    uint8_t batterySoc;
+    float batteryCurrent;
+
+    void decode(WireReader& reader) {
+        timestamp = reader.read<uint64_t>();
+        panelPower = reader.read<float>();
+        batteryChargePower = reader.read<float>();
+        loadVoltage = reader.read<float>();
+        loadCurrent = reader.read<float>();
+        loadPower = reader.read<float>();
+        batteryTemperature = reader.read<float>();
+        deviceTemperature = reader.read<float>();
+        batterySoc = reader.read<uint8_t>();
+        batteryCurrent = reader.read<float>();
+    }
+};
+
+// Daily extremes in V and energy counters in kWh, as kept by the charge controller
+struct EnergyCounters {
+    uint64_t timestamp;
+    float panelVoltageMaxToday;
+    float panelVoltageMinToday;
+    float batteryVoltageMaxToday;
+    float batteryVoltageMinToday;
+    float consumedToday;
+    float consumedMonth;
+    float consumedYear;
+    float consumedTotal;
+    float generatedToday;
+    float generatedMonth;
+    float generatedYear;
+    float generatedTotal;
+
+    void decode(WireReader& reader) {
+        timestamp = reader.read<uint64_t>();
+        panelVoltageMaxToday = reader.read<float>();
+        panelVoltageMinToday = reader.read<float>();
+        batteryVoltageMaxToday = reader.read<float>();
+        batteryVoltageMinToday = reader.read<float>();
+        consumedToday = reader.read<float>();
+        consumedMonth = reader.read<float>();
+        consumedYear = reader.read<float>();
+        consumedTotal = reader.read<float>();
+        generatedToday = reader.read<float>();
+        generatedMonth = reader.read<float>();
+        generatedYear = reader.read<float>();
+        generatedTotal = reader.read<float>();
+    }
+};
+
+struct Status {
+    bool wrongVoltageIdentification;
+    Temperature temperature;
+    Battery battery;
+    Charging charging;
+    Arrays arrays;
+    Load load;
+
+    void decode(WireReader& reader) {
+        wrongVoltageIdentification = reader.read<uint8_t>() != 0;
+        temperature = reader.read<Temperature>();
+        battery = reader.read<Battery>();
+        charging = reader.read<Charging>();
+        arrays = reader.read<Arrays>();
+        load = reader.read<Load>();
+    }
+};
+
+struct Meteo {
+    uint64_t timestamp;
+    float pressure;
+    float temperature;
+
+    void decode(WireReader& reader) {
+        timestamp = reader.read<uint64_t>();
+        pressure = reader.read<float>();
+        temperature = reader.read<float>();
+    }
+};
+
+struct Beacon {
+    Telemetry telemetry;
+    Status status;
+
+    void decode(WireReader& reader) {
+        telemetry.decode(reader);
+        status.decode(reader);
+    }
+};
+
+struct SensorChannel {
+    SensorQuantity quantity;
+    float value;
+};
+
+struct SensorReading {
+    SensorType type;
+    SensorStatus status;
+    std::vector<SensorChannel> channels;
+};
+
+struct SensorList {
+    std::vector<SensorReading> sensors;
+
+    void decode(WireReader& reader) {
+        const auto count = reader.read<uint8_t>();
+        sensors.clear();
+        for (uint8_t id = 0; id < count && reader.isValid(); id++) {
+            SensorReading sensor;
+            sensor.type = reader.read<SensorType>();
+            sensor.status = reader.read<SensorStatus>();
+            const auto channels = reader.read<uint8_t>();
+            for (uint8_t channel = 0; channel < channels && reader.isValid(); channel++) {
+                SensorChannel item;
+                item.quantity = reader.read<SensorQuantity>();
+                item.value = reader.read<float>();
+                sensor.channels.push_back(item);
+            }
+            sensors.push_back(sensor);
+        }
+    }
+};
+
+struct Diagnostics {
+    uint32_t uptime;
+    uint8_t resetCause;
+    uint16_t ramSize;
+    uint16_t staticRam;
+    uint16_t stackHighWaterMark;
+    uint16_t stackUnused;
+    uint16_t heapFree;
+    uint16_t heapLargestFreeBlock;
+    uint16_t failedSends;
+    uint16_t i2cTimeouts;
+    uint16_t i2cRecoveries;
+
+    void decode(WireReader& reader) {
+        uptime = reader.read<uint32_t>();
+        resetCause = reader.read<uint8_t>();
+        ramSize = reader.read<uint16_t>();
+        staticRam = reader.read<uint16_t>();
+        stackHighWaterMark = reader.read<uint16_t>();
+        stackUnused = reader.read<uint16_t>();
+        heapFree = reader.read<uint16_t>();
+        heapLargestFreeBlock = reader.read<uint16_t>();
+        failedSends = reader.read<uint16_t>();
+        i2cTimeouts = reader.read<uint16_t>();
+        i2cRecoveries = reader.read<uint16_t>();
+    }
+};
+
+struct Statistics {
+    uint16_t epoch;
+    uint32_t duration;
+    uint32_t samples;
+    float batteryVoltageMin;
+    float batteryVoltageMax;
+    float batteryVoltageMean;
+    float panelPowerMin;
+    float panelPowerMax;
+    float panelPowerMean;
+    float energyHarvested;
+    float chargeAccumulated;
+
+    void decode(WireReader& reader) {
+        epoch = reader.read<uint16_t>();
+        duration = reader.read<uint32_t>();
+        samples = reader.read<uint32_t>();
+        batteryVoltageMin = reader.read<float>();
+        batteryVoltageMax = reader.read<float>();
+        batteryVoltageMean = reader.read<float>();
+        panelPowerMin = reader.read<float>();
+        panelPowerMax = reader.read<float>();
+        panelPowerMean = reader.read<float>();
+        energyHarvested = reader.read<float>();
+        chargeAccumulated = reader.read<float>();
+    }
+};
+
+struct OutputState {
+    uint8_t output;
+    bool on;
+
+    void decode(WireReader& reader) {
+        output = reader.read<uint8_t>();
+        on = reader.read<uint8_t>() != 0;
+    }
+};
+
+struct LoadSettings {
+    uint8_t priority;
+    float offVoltage;
+    float onVoltage;
+    uint16_t settleTime;
+};
+
+struct LoadTable {
+    uint8_t powered;
+    std::vector<LoadSettings> channels;
+
+    void decode(WireReader& reader) {
+        powered = reader.read<uint8_t>();
+        const auto count = reader.read<uint8_t>();
+        channels.clear();
+        for (uint8_t channel = 0; channel < count && reader.isValid(); channel++) {
+            LoadSettings settings;
+            settings.priority = reader.read<uint8_t>();
+            settings.offVoltage = reader.read<float>();
+            settings.onVoltage = reader.read<float>();
+            settings.settleTime = reader.read<uint16_t>();
+            channels.push_back(settings);
+        }
+    }
+};
+
+struct LoadTableUpdate {
+    bool applied;
+    LoadTable table;
+
+    void decode(WireReader& reader) {
+        applied = reader.read<uint8_t>() != 0;
+        table.decode(reader);
+    }
+};
+
+// Raw value bytes, the width depends on the parameter type
+struct ConfigValue {
+    char id;
+    std::vector<uint8_t> value;
+
+    void decode(WireReader& reader) {
+        id = reader.read<char>();
+        value = reader.readRemaining();
+    }
+
+    [[nodiscard]]
+    float asFloat() const {
+        return value.size() == sizeof(float) ? WireReader(value.data(), value.size()).read<float>() : 0;
+    }
+
+    [[nodiscard]]
+    uint16_t asUint16() const {
+        return value.size() == sizeof(uint16_t) ? WireReader(value.data(), value.size()).read<uint16_t>() : 0;
+    }
+
+    [[nodiscard]]
+    uint8_t asUint8() const {
+        return value.size() == sizeof(uint8_t) ? value[0] : 0;
+    }
+};
+
+struct EventRecord {
+    uint16_t sequence;
+    EventCode code;
+    uint8_t param;
+    uint8_t value;
+    uint64_t timestamp;
+
+    void decode(WireReader& reader) {
+        sequence = reader.read<uint16_t>();
+        code = reader.read<EventCode>();
+        param = reader.read<uint8_t>();
+        value = reader.read<uint8_t>();
+        timestamp = reader.read<uint64_t>();
+    }
+};
+
+struct LogPage {
+    uint16_t page;
+    uint16_t total;
+    std::vector<EventRecord> records;
+
+    void decode(WireReader& reader) {
+        page = reader.read<uint16_t>();
+        total = reader.read<uint16_t>();
+        const auto count = reader.read<uint8_t>();
+        records.resize(count);
+        for (EventRecord& record : records)
+            record.decode(reader);
+    }
+};
+
+// NTP timestamps of one exchange: the client transmit time echoed, the station receive and transmit times
+struct TimeSync {
+    uint64_t clientTime;
+    uint64_t receiveTime;
+    bool synced;
+    float drift;
+    uint64_t transmitTime;
+
+    void decode(WireReader& reader) {
+        clientTime = reader.read<uint64_t>();
+        receiveTime = reader.read<uint64_t>();
+        synced = reader.read<uint8_t>() != 0;
+        drift = reader.read<float>();
+        transmitTime = reader.read<uint64_t>();
+    }
+};
+
+struct ClockEstimate {
+    int64_t offset;
+    int64_t roundTrip;
+};
+
+// Offset the station clock has to move by and the network round trip, from an exchange answered at receivedAt
+inline ClockEstimate estimateClock(const TimeSync& sync, const uint64_t receivedAt) {
+    const auto t1 = static_cast<int64_t>(sync.clientTime);
+    const auto t2 = static_cast<int64_t>(sync.receiveTime);
+    const auto t3 = static_cast<int64_t>(sync.transmitTime);
+    const auto t4 = static_cast<int64_t>(receivedAt);
+    return {((t1 - t2) + (t4 - t3)) / 2, (t4 - t1) - (t3 - t2)};
+}
+
+struct Subscription {
+    uint8_t slot;
+    uint16_t lastSequence;
+
+    void decode(WireReader& reader) {
+        slot = reader.read<uint8_t>();
+        lastSequence = reader.read<uint16_t>();
+    }
+};
+
+// Requests: the opcode, the response type, whether a duplicate may share or repeat it, and the arguments
+template <char Opcode, typename R, bool Idempotent = true>
+struct PlainRequest {
+    static constexpr char opcode = Opcode;
+    static constexpr bool idempotent = Idempotent;
+    using Response = R;
+
+    void encode(WireWriter&) const {}
+};
+
+using PingRequest = PlainRequest<PROTOCOL_PING, PingReply>;
+using TelemetryRequest = PlainRequest<PROTOCOL_TELEMETRY, Telemetry>;
+using StatusRequest = PlainRequest<PROTOCOL_STATUS, Status>;
+using MeteoRequest = PlainRequest<PROTOCOL_METEO, Meteo>;
+using SensorsRequest = PlainRequest<PROTOCOL_SENSORS_READ, SensorList>;
+using DiagnosticsRequest = PlainRequest<PROTOCOL_DIAGNOSTICS, Diagnostics>;
+using StatisticsRequest = PlainRequest<PROTOCOL_STATS_READ, Statistics>;
+using StatisticsResetRequest = PlainRequest<PROTOCOL_STATS_RESET, Statistics, false>;
+using LoadsRequest = PlainRequest<PROTOCOL_LOADS_READ, LoadTable>;
+using ControllerRequest = PlainRequest<PROTOCOL_CONTROLLER_READ, ControllerDetails>;
+using EnergyRequest = PlainRequest<PROTOCOL_ENERGY_READ, EnergyCounters>;
+using SubscribeRequest = PlainRequest<PROTOCOL_EVENT_SUBSCRIBE, Subscription>;
+using UnsubscribeRequest = PlainRequest<PROTOCOL_EVENT_UNSUBSCRIBE, Empty>;
+
+struct OutputReadRequest {
+    static constexpr char opcode = PROTOCOL_OUTPUT_READ;
+    static constexpr bool idempotent = true;
+    using Response = OutputState;
+
+    uint8_t output;
+
+    void encode(WireWriter& writer) const {
+        writer.write(output);
+    }
+};
+
+struct OutputSetRequest {
+    static constexpr char opcode = PROTOCOL_OUTPUT_SET;
+    static constexpr bool idempotent = true;
+    using Response = OutputState;
+
+    uint8_t output;
+    bool on;
+
+    void encode(WireWriter& writer) const {
+        writer.write(output);
+        writer.write(static_cast<uint8_t>(on ? 0x01 : 0x00));
+    }
+};
+
+struct LoadsSetRequest {
+    static constexpr char opcode = PROTOCOL_LOADS_SET;
+    static constexpr bool idempotent = true;
+    using Response = LoadTableUpdate;
+
+    uint8_t channel;
+    LoadSettings settings;
+
+    void encode(WireWriter& writer) const {
+        writer.write(channel);
+        writer.write(settings.priority);
+        writer.write(settings.offVoltage);
+        writer.write(settings.onVoltage);
+        writer.write(settings.settleTime);
+    }
+};
+
+// Carries the offset estimated on the previous exchange, applying it twice would move the clock twice
+struct TimeSyncRequest {
+    static constexpr char opcode = PROTOCOL_TIME_SYNC;
+    static constexpr bool idempotent = false;
+    using Response = TimeSync;
+
+    uint64_t clientTime;
+    int64_t offset;
+
+    void encode(WireWriter& writer) const {
+        writer.write(clientTime);
+        writer.write(offset);
+    }
+};
+
+struct ConfigReadRequest {
+    static constexpr char opcode = PROTOCOL_CONFIG_READ;
+    static constexpr bool idempotent = true;
+    using Response = ConfigValue;
+
+    char id;
+
+    void encode(WireWriter& writer) const {
+        writer.write(id);
+    }
+};
+
+struct LogReadRequest {
+    static constexpr char opcode = PROTOCOL_LOG_READ;
+    static constexpr bool idempotent = true;
+    using Response = LogPage;
+
+    uint16_t page;
+
+    void encode(WireWriter& writer) const {
+        writer.write(page);
+    }
+};
+
+struct EventAckRequest {
+    static constexpr char opcode = PROTOCOL_EVENT_ACK;
+    static constexpr bool idempotent = true;
+    using Response = Empty;
+
+    uint16_t sequence;
+
+    void encode(WireWriter& writer) const {
+        writer.write(sequence);
+    }
+};
+
+template <typename T>
+struct ClientResult {
+    ClientError error;
+    T value;
+};
+
+// Decodes one response body, the bytes after the echoed header and opcode
+template <typename T>
+ClientError decodeResponse(const uint8_t* data, const size_t size, T& value) {
+    WireReader reader(data, size);
+    value.decode(reader);
+    return reader.isValid() ? ClientError::None : ClientError::Malformed;
+}
+
+// Non-blocking UDP client for one station. Requests carry the protocol header, so several can be in flight
+// (pipelining); identical idempotent requests in flight or queued share one datagram (coalescing); unanswered
+// idempotent requests are sent again (retries). Drive it with run(), or register getFd() in an event loop and
+// call process() on readiness and at least every few milliseconds.
+class StationClient {
+    public:
+
+        StationClient() {
+            fd = -1;
+            timeout = CLIENT_DEFAULT_TIMEOUT;
+            retries = CLIENT_DEFAULT_RETRIES;
+            window = CLIENT_DEFAULT_WINDOW;
+            coalescing = true;
+            nextSequence = 0;
+            sent = 0;
+            retransmits = 0;
+            coalesced = 0;
+            timeouts = 0;
+        }
+
+        ~StationClient() {
+            close();
+        }
+
+        StationClient(const StationClient&) = delete;
+
+        StationClient& operator=(const StationClient&) = delete;
+
+        bool open(const char* host, const uint16_t port = NETWORK_UDP_PORT) {
+            close();
+
+            addrinfo hints = {};
+            hints.ai_family = AF_INET;
+            hints.ai_socktype = SOCK_DGRAM;
+            addrinfo* address = nullptr;
+            const std::string service = std::to_string(port);
+            if (getaddrinfo(host, service.c_str(), &hints, &address) != 0)
+                return false;
+
+            fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            const bool connected = fd >= 0 && connect(fd, address->ai_addr, address->ai_addrlen) == 0;
+            freeaddrinfo(address);
+
+            if (!connected)
+                close();
+            return connected;
+        }
+
+        void close() {
+            if (fd >= 0)
+                ::close(fd);
+            fd = -1;
+
+            // Every outstanding callback still gets exactly one answer
+            failAll(ClientError::Transport);
+        }
+
+        [[nodiscard]]
+        int getFd() const {
+            return fd;
+        }
+
+        void setTimeout(const uint32_t timeout) {
+            this->timeout = timeout;
+        }
+
+        void setRetries(const uint8_t retries) {
+            this->retries = retries;
+        }
+
+        void setWindow(const size_t window) {
+            this->window = window > 0 ? window : 1;
+        }
+
+        void setCoalescing(const bool coalescing) {
+            this->coalescing = coalescing;
+        }
+
+        void setUnsolicitedHandler(std::function<void(const uint8_t* data, size_t size)> handler) {
+            unsolicitedHandler = std::move(handler);
+        }
+
+        template <typename R>
+        void submit(const R& request, std::function<void(const ClientResult<typename R::Response>&)> callback) {
+            std::vector<uint8_t> body;
+            body.push_back(static_cast<uint8_t>(R::opcode));
+            WireWriter writer(body);
+            request.encode(writer);
+
+            Waiter waiter = [callback](const ClientError error, const uint8_t* data, const size_t size) {
+                ClientResult<typename R::Response> result{error, {}};
+                if (error == ClientError::None)
+                    result.error = decodeResponse(data, size, result.value);
+                callback(result);
+            };
+
+            if (R::idempotent && coalescing && coalesce(body, waiter))
+                return;
+
+            Pending pending;
+            pending.body = std::move(body);
+            pending.idempotent = R::idempotent;
+            pending.attempts = 0;
+            pending.sentAt = 0;
+            pending.waiters.push_back(std::move(waiter));
+            queue.push_back(std::move(pending));
+
+            flush();
+        }
+
+        // Blocking convenience on top of submit(), for scripts and one-shot tools
+        template <typename R>
+        ClientResult<typename R::Response> call(const R& request) {
+            ClientResult<typename R::Response> result{ClientError::Timeout, {}};
+            bool done = false;
+            submit(request, [&](const ClientResult<typename R::Response>& response) {
+                result = response;
+                done = true;
+            });
+
+            while (!done)
+                run(timeout);
+            return result;
+        }
+
+        void process() {
+            receive();
+            expire();
+            flush();
+        }
+
+        // Waits up to timeoutMs for traffic or the next deadline, then processes; false once idle
+        bool run(const int timeoutMs) {
+            if (isIdle())
+                return false;
+
+            pollfd descriptor = {fd, POLLIN, 0};
+            poll(&descriptor, 1, std::min(timeoutMs, getNextDeadline()));
+            process();
+            return !isIdle();
+        }
+
+        [[nodiscard]]
+        bool isIdle() const {
+            return inFlight.empty() && queue.empty();
+        }
+
+        [[nodiscard]]
+        size_t getInFlight() const {
+            return inFlight.size();
+        }
+
+        [[nodiscard]]
+        uint64_t getSent() const {
+            return sent;
+        }
+
+        [[nodiscard]]
+        uint64_t getRetransmits() const {
+            return retransmits;
+        }
+
+        [[nodiscard]]
+        uint64_t getCoalesced() const {
+            return coalesced;
+        }
+
+        [[nodiscard]]
+        uint64_t getTimeouts() const {
+            return timeouts;
+        }
+
+    private:
+
+        using Waiter = std::function<void(ClientError error, const uint8_t* data, size_t size)>;
+
+        struct Pending {
+            std::vector<uint8_t> body;
+            bool idempotent;
+            uint8_t attempts;
+            uint64_t sentAt;
+            std::vector<Waiter> waiters;
+        };
+
+        int fd;
+        uint32_t timeout;
+        uint8_t retries;
+        size_t window;
+        bool coalescing;
+        uint16_t nextSequence;
+
+        std::map<uint16_t, Pending> inFlight;
+        std::deque<Pending> queue;
+        std::function<void(const uint8_t* data, size_t size)> unsolicitedHandler;
+
+        uint64_t sent;
+        uint64_t retransmits;
+        uint64_t coalesced;
+        uint64_t timeouts;
+
+        static uint64_t now() {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+        }
+
+        bool coalesce(const std::vector<uint8_t>& body, Waiter& waiter) {
+            for (auto& [sequence, pending] : inFlight) {
+                if (pending.idempotent && pending.body == body) {
+                    pending.waiters.push_back(std::move(waiter));
+                    coalesced++;
+                    return true;
+                }
+            }
+
+            for (Pending& pending : queue) {
+                if (pending.idempotent && pending.body == body) {
+                    pending.waiters.push_back(std::move(waiter));
+                    coalesced++;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        void transmit(const uint16_t sequence, Pending& pending) {
+            std::vector<uint8_t> datagram = {static_cast<uint8_t>(PROTOCOL_HEADER), PROTOCOL_VERSION,
+                                             static_cast<uint8_t>(sequence >> 8), static_cast<uint8_t>(sequence)};
+            datagram.insert(datagram.end(), pending.body.begin(), pending.body.end());
+
+            if (fd >= 0 && ::send(fd, datagram.data(), datagram.size(), 0) >= 0)
+                sent++;
+
+            pending.attempts++;
+            pending.sentAt = now();
+        }
+
+        void flush() {
+            while (!queue.empty() && inFlight.size() < window) {
+                // Skip sequences still in flight after a wrap, 64k outstanding requests never happen
+                while (inFlight.count(nextSequence) > 0)
+                    nextSequence++;
+
+                const uint16_t sequence = nextSequence++;
+                Pending& pending = inFlight[sequence] = std::move(queue.front());
+                queue.pop_front();
+                transmit(sequence, pending);
+            }
+        }
+
+        void receive() {
+            uint8_t datagram[CLIENT_DATAGRAM_SIZE];
+            while (fd >= 0) {
+                const ssize_t size = recv(fd, datagram, sizeof(datagram), 0);
+                if (size < 0)
+                    return;
+
+                if (size <= PROTOCOL_HEADER_SIZE || datagram[0] != PROTOCOL_HEADER) {
+                    if (unsolicitedHandler)
+                        unsolicitedHandler(datagram, size);
+                    continue;
+                }
+
+                const uint16_t sequence = (datagram[2] << 8) | datagram[3];
+                const auto found = inFlight.find(sequence);
+                if (found == inFlight.end())
+                    continue;
+
+                Pending pending = std::move(found->second);
+                inFlight.erase(found);
+
+                const char opcode = static_cast<char>(datagram[PROTOCOL_HEADER_SIZE]);
+                const uint8_t* body = datagram + PROTOCOL_HEADER_SIZE + 1;
+                const size_t bodySize = size - PROTOCOL_HEADER_SIZE - 1;
+
+                ClientError error = ClientError::None;
+                if (opcode == PROTOCOL_NACK)
+                    error = ClientError::Nack;
+                else if (datagram[1] != PROTOCOL_VERSION || opcode != static_cast<char>(pending.body[0]))
+                    error = ClientError::Malformed;
+
+                for (Waiter& waiter : pending.waiters)
+                    waiter(error, body, bodySize);
+            }
+        }
+
+        void expire() {
+            const uint64_t current = now();
+            for (auto it = inFlight.begin(); it != inFlight.end();) {
+                Pending& pending = it->second;
+                if (current - pending.sentAt < timeout) {
+                    ++it;
+                    continue;
+                }
+
+                if (pending.idempotent && pending.attempts <= retries) {
+                    retransmits++;
+                    transmit(it->first, pending);
+                    ++it;
+                    continue;
+                }
+
+                timeouts++;
+                Pending expired = std::move(pending);
+                it = inFlight.erase(it);
+                for (Waiter& waiter : expired.waiters)
+                    waiter(ClientError::Timeout, nullptr, 0);
+            }
+        }
+
+        void failAll(const ClientError error) {
+            std::vector<Pending> failed;
+            for (auto& [sequence, pending] : inFlight)
+                failed.push_back(std::move(pending));
+            for (Pending& pending : queue)
+                failed.push_back(std::move(pending));
+            inFlight.clear();
+            queue.clear();
+
+            for (Pending& pending : failed)
+                for (Waiter& waiter : pending.waiters)
+                    waiter(error, nullptr, 0);
+        }
+
+        [[nodiscard]]
+        int getNextDeadline() const {
+            const uint64_t current = now();
+            uint64_t deadline = timeout;
+            for (const auto& [sequence, pending] : inFlight) {
+                const uint64_t elapsed = current - pending.sentAt;
+                const uint64_t remaining = elapsed >= timeout ? 0 : timeout - elapsed;
+                if (remaining < deadline)
+                    deadline = remaining;
+            }
+            return static_cast<int>(deadline);
+        }
+};
+
+#endif
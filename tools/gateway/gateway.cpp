@@ -0,0 +1,408 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <getopt.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "const.hpp"
+#include "http.hpp"
+#include "protocol.hpp"
+#include "station.hpp"
+
+#define GATEWAY_DEFAULT_HTTP_PORT 8080
+#define GATEWAY_DEFAULT_INTERVAL 5000
+#define GATEWAY_DEFAULT_HISTORY 720
+#define GATEWAY_TICK 50
+#define GATEWAY_DATAGRAM_SIZE 1500
+#define GATEWAY_EPOLL_EVENTS 32
+
+static uint64_t monotonicClock() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000ULL + now.tv_nsec / 1000000;
+}
+
+static uint64_t addressKey(const sockaddr_in& address) {
+    return (static_cast<uint64_t>(address.sin_addr.s_addr) << 16) | address.sin_port;
+}
+
+static int openUdp(const uint16_t port) {
+    const int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static bool watch(const int epollFd, const int fd) {
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    return epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+static bool loadStations(const char* path, const size_t historySize, std::vector<Station>& stations) {
+    FILE* file = fopen(path, "r");
+    if (file == nullptr) {
+        perror(path);
+        return false;
+    }
+
+    char line[256];
+    unsigned int lineNumber = 0;
+    bool valid = true;
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        lineNumber++;
+
+        char name[64];
+        char host[64];
+        unsigned int port = NETWORK_UDP_PORT;
+        if (line[0] == '#' || sscanf(line, "%63s %63s %u", name, host, &port) < 2)
+            continue;
+
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        if (inet_pton(AF_INET, host, &address.sin_addr) != 1 || port == 0 || port > 0xFFFF) {
+            fprintf(stderr, "%s:%u: invalid address %s:%u\n", path, lineNumber, host, port);
+            valid = false;
+            continue;
+        }
+
+        stations.emplace_back(name, address, historySize);
+    }
+
+    fclose(file);
+    return valid;
+}
+
+class Gateway {
+    public:
+
+        Gateway(std::vector<Station>& stations, uint64_t interval)
+            : stations(stations),
+              http([this](const std::string& path, std::string& body) { return route(path, body); }) {
+            this->interval = interval;
+            epollFd = -1;
+            pollFd = -1;
+            beaconFd = -1;
+            timerFd = -1;
+            signalFd = -1;
+            sequence = 0;
+            startTime = 0;
+            sent = 0;
+            unmatched = 0;
+        }
+
+        bool begin(const uint16_t httpPort, const uint16_t beaconPort) {
+            epollFd = epoll_create1(EPOLL_CLOEXEC);
+            pollFd = openUdp(0);
+            if (epollFd < 0 || pollFd < 0 || !watch(epollFd, pollFd)) {
+                perror("poll socket");
+                return false;
+            }
+
+            if (beaconPort != 0) {
+                beaconFd = openUdp(beaconPort);
+                if (beaconFd < 0 || !watch(epollFd, beaconFd)) {
+                    perror("beacon socket");
+                    return false;
+                }
+            }
+
+            if (!http.begin(httpPort, epollFd)) {
+                perror("http socket");
+                return false;
+            }
+
+            timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+            itimerspec tick = {};
+            tick.it_interval.tv_nsec = GATEWAY_TICK * 1000000L;
+            tick.it_value = tick.it_interval;
+            if (timerFd < 0 || timerfd_settime(timerFd, 0, &tick, nullptr) < 0 || !watch(epollFd, timerFd)) {
+                perror("timer");
+                return false;
+            }
+
+            sigset_t signals;
+            sigemptyset(&signals);
+            sigaddset(&signals, SIGINT);
+            sigaddset(&signals, SIGTERM);
+            sigprocmask(SIG_BLOCK, &signals, nullptr);
+            signalFd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+            if (signalFd < 0 || !watch(epollFd, signalFd)) {
+                perror("signals");
+                return false;
+            }
+
+            // Cycles are spread over the interval, so the poll traffic stays flat
+            startTime = monotonicClock();
+            for (size_t i = 0; i < stations.size(); i++) {
+                stations[i].schedule(startTime + interval * i / stations.size(), interval);
+                byAddress[addressKey(stations[i].getAddress())] = i;
+                byHost[stations[i].getAddress().sin_addr.s_addr] = i;
+            }
+
+            return true;
+        }
+
+        void run() {
+            epoll_event events[GATEWAY_EPOLL_EVENTS];
+            bool running = true;
+
+            while (running) {
+                const int count = epoll_wait(epollFd, events, GATEWAY_EPOLL_EVENTS, -1);
+                if (count < 0) {
+                    if (errno == EINTR)
+                        continue;
+                    perror("epoll_wait");
+                    return;
+                }
+
+                for (int i = 0; i < count; i++) {
+                    const int fd = events[i].data.fd;
+                    if (fd == pollFd) {
+                        receiveResponses();
+                    } else if (fd == beaconFd) {
+                        receiveBeacons();
+                    } else if (fd == timerFd) {
+                        uint64_t expirations;
+                        while (read(timerFd, &expirations, sizeof(expirations)) > 0) {}
+                        tick();
+                    } else if (fd == signalFd) {
+                        running = false;
+                    } else if (http.owns(fd)) {
+                        http.handle(fd, events[i].events);
+                    }
+                }
+            }
+        }
+
+    private:
+
+        std::vector<Station>& stations;
+        std::map<uint64_t, size_t> byAddress;
+        std::map<in_addr_t, size_t> byHost;
+        HttpServer http;
+
+        uint64_t interval;
+        int epollFd;
+        int pollFd;
+        int beaconFd;
+        int timerFd;
+        int signalFd;
+
+        uint16_t sequence;
+        uint64_t startTime;
+        uint64_t sent;
+        uint64_t unmatched;
+
+        void tick() {
+            const uint64_t now = monotonicClock();
+            for (Station& station : stations) {
+                station.checkTimeout(now);
+                if (station.isDue(now))
+                    send(station, now);
+            }
+        }
+
+        void send(Station& station, const uint64_t now) {
+            uint8_t request[PROTOCOL_HEADER_SIZE + 1 + PROTOCOL_TIME_SYNC_REQUEST_SIZE];
+            const size_t size = station.buildRequest(request, sequence++, now);
+
+            const sockaddr_in& address = station.getAddress();
+            if (sendto(pollFd, request, size, 0, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) > 0)
+                sent++;
+        }
+
+        void receiveResponses() {
+            uint8_t datagram[GATEWAY_DATAGRAM_SIZE];
+            sockaddr_in source;
+            socklen_t sourceSize = sizeof(source);
+
+            while (true) {
+                const ssize_t size = recvfrom(pollFd, datagram, sizeof(datagram), 0,
+                                              reinterpret_cast<sockaddr*>(&source), &sourceSize);
+                if (size < 0)
+                    return;
+
+                const auto found = byAddress.find(addressKey(source));
+                const uint64_t now = monotonicClock();
+                if (found == byAddress.end() || !stations[found->second].handleResponse(datagram, size, now)) {
+                    unmatched++;
+                    continue;
+                }
+
+                // The next request of the cycle leaves right away instead of waiting for the tick
+                Station& station = stations[found->second];
+                if (station.isDue(now))
+                    send(station, now);
+            }
+        }
+
+        void receiveBeacons() {
+            uint8_t datagram[GATEWAY_DATAGRAM_SIZE];
+            sockaddr_in source;
+            socklen_t sourceSize = sizeof(source);
+
+            while (true) {
+                const ssize_t size = recvfrom(beaconFd, datagram, sizeof(datagram), 0,
+                                              reinterpret_cast<sockaddr*>(&source), &sourceSize);
+                if (size < 0)
+                    return;
+
+                const auto found = byHost.find(source.sin_addr.s_addr);
+                if (found == byHost.end() || !stations[found->second].handleBeacon(datagram, size, monotonicClock()))
+                    unmatched++;
+            }
+        }
+
+        int route(const std::string& path, std::string& body) {
+            const uint64_t now = monotonicClock();
+
+            if (path == "/gateway") {
+                char buffer[256];
+                snprintf(buffer, sizeof(buffer),
+                         "{\"stations\":%zu,\"uptime\":%llu,\"interval\":%llu,\"sent\":%llu,\"unmatched\":%llu}",
+                         stations.size(), static_cast<unsigned long long>((now - startTime) / 1000),
+                         static_cast<unsigned long long>(interval), static_cast<unsigned long long>(sent),
+                         static_cast<unsigned long long>(unmatched));
+                body = buffer;
+                return 200;
+            }
+
+            if (path == "/stations" || path == "/stations/") {
+                body = "[";
+                for (size_t i = 0; i < stations.size(); i++) {
+                    if (i > 0)
+                        body += ",";
+                    stations[i].toJson(body, now);
+                }
+                body += "]";
+                return 200;
+            }
+
+            static const std::string prefix = "/stations/";
+            static const std::string historySuffix = "/history";
+            if (path.compare(0, prefix.size(), prefix) != 0)
+                return 404;
+
+            std::string name = path.substr(prefix.size());
+            const bool history = name.size() > historySuffix.size()
+                                 && name.compare(name.size() - historySuffix.size(), historySuffix.size(), historySuffix) == 0;
+            if (history)
+                name.resize(name.size() - historySuffix.size());
+
+            for (const Station& station : stations) {
+                if (station.getName() != name)
+                    continue;
+
+                if (history)
+                    station.historyToJson(body);
+                else
+                    station.toJson(body, now);
+                return 200;
+            }
+
+            return 404;
+        }
+};
+
+static void usage(const char* name) {
+    fprintf(stderr, "Usage: %s [-p http_port] [-i interval_ms] [-H history] [-b beacon_port] stations.conf\n", name);
+}
+
+int main(int argc, char** argv) {
+    unsigned long httpPort = GATEWAY_DEFAULT_HTTP_PORT;
+    unsigned long interval = GATEWAY_DEFAULT_INTERVAL;
+    unsigned long historySize = GATEWAY_DEFAULT_HISTORY;
+    unsigned long beaconPort = NETWORK_BEACON_PORT;
+
+    int option;
+    while ((option = getopt(argc, argv, "p:i:H:b:h")) != -1) {
+        switch (option) {
+            case 'p':
+                httpPort = strtoul(optarg, nullptr, 0);
+                break;
+            case 'i':
+                interval = strtoul(optarg, nullptr, 0);
+                break;
+            case 'H':
+                historySize = strtoul(optarg, nullptr, 0);
+                break;
+            case 'b':
+                beaconPort = strtoul(optarg, nullptr, 0);
+                break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+
+    if (optind != argc - 1 || httpPort == 0 || httpPort > 0xFFFF || beaconPort > 0xFFFF || interval == 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::vector<Station> stations;
+    if (!loadStations(argv[optind], historySize, stations))
+        return 2;
+    if (stations.empty()) {
+        fprintf(stderr, "%s: no stations\n", argv[optind]);
+        return 2;
+    }
+
+    Gateway gateway(stations, interval);
+    if (!gateway.begin(httpPort, beaconPort))
+        return 1;
+
+    printf("Polling %zu stations every %lu ms, dashboards on port %lu\n", stations.size(), interval, httpPort);
+    fflush(stdout);
+
+    gateway.run();
+    return 0;
+}
@@ -0,0 +1,213 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "http.hpp"
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static const char* getReason(const int status) {
+    switch (status) {
+        case 200:
+            return "OK";
+        case 400:
+            return "Bad Request";
+        case 404:
+            return "Not Found";
+        case 405:
+            return "Method Not Allowed";
+        default:
+            return "Error";
+    }
+}
+
+HttpServer::HttpServer(HttpHandler handler) {
+    this->handler = std::move(handler);
+    listenFd = -1;
+    epollFd = -1;
+}
+
+HttpServer::~HttpServer() {
+    while (!connections.empty())
+        close(connections.begin()->first);
+
+    if (listenFd >= 0)
+        ::close(listenFd);
+}
+
+bool HttpServer::begin(const uint16_t port, const int epollFd) {
+    this->epollFd = epollFd;
+
+    listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0)
+        return false;
+
+    const int reuse = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(listenFd, 64) < 0)
+        return false;
+
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = listenFd;
+    return epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event) == 0;
+}
+
+bool HttpServer::owns(const int fd) const {
+    return fd == listenFd || connections.count(fd) > 0;
+}
+
+void HttpServer::handle(const int fd, const uint32_t events) {
+    if (fd == listenFd) {
+        accept();
+        return;
+    }
+
+    const auto found = connections.find(fd);
+    if (found == connections.end())
+        return;
+
+    if (events & (EPOLLERR | EPOLLHUP)) {
+        close(fd);
+        return;
+    }
+
+    if (events & EPOLLIN)
+        receive(fd, found->second);
+    else if (events & EPOLLOUT)
+        transmit(fd, found->second);
+}
+
+void HttpServer::accept() {
+    while (true) {
+        const int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+            return;
+
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            ::close(fd);
+            continue;
+        }
+
+        connections[fd] = Connection{"", "", 0};
+    }
+}
+
+void HttpServer::receive(const int fd, Connection& connection) {
+    char buffer[1024];
+    while (true) {
+        const ssize_t size = recv(fd, buffer, sizeof(buffer), 0);
+        if (size == 0) {
+            close(fd);
+            return;
+        }
+        if (size < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            close(fd);
+            return;
+        }
+
+        connection.request.append(buffer, size);
+        if (connection.request.size() > HTTP_REQUEST_MAX_SIZE) {
+            close(fd);
+            return;
+        }
+    }
+
+    // Only the request line matters, the headers are read and ignored
+    if (connection.request.find("\r\n\r\n") != std::string::npos || connection.request.find("\n\n") != std::string::npos)
+        respond(fd, connection);
+}
+
+void HttpServer::respond(const int fd, Connection& connection) {
+    std::string body;
+    int status;
+
+    const size_t methodEnd = connection.request.find(' ');
+    const size_t pathEnd = connection.request.find(' ', methodEnd + 1);
+    if (methodEnd == std::string::npos || pathEnd == std::string::npos) {
+        status = 400;
+    } else if (connection.request.compare(0, methodEnd, "GET") != 0) {
+        status = 405;
+    } else {
+        std::string path = connection.request.substr(methodEnd + 1, pathEnd - methodEnd - 1);
+        const size_t query = path.find('?');
+        if (query != std::string::npos)
+            path.resize(query);
+        status = handler(path, body);
+    }
+
+    if (status != 200)
+        body = "{\"error\":\"" + std::string(getReason(status)) + "\"}";
+
+    char header[256];
+    snprintf(header, sizeof(header),
+             "HTTP/1.0 %d %s\r\n"
+             "Content-Type: application/json\r\n"
+             "Content-Length: %zu\r\n"
+             "Access-Control-Allow-Origin: *\r\n"
+             "Connection: close\r\n\r\n",
+             status, getReason(status), body.size());
+
+    connection.response = header + body;
+    connection.sent = 0;
+
+    epoll_event event = {};
+    event.events = EPOLLOUT;
+    event.data.fd = fd;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event);
+
+    transmit(fd, connection);
+}
+
+void HttpServer::transmit(const int fd, Connection& connection) {
+    while (connection.sent < connection.response.size()) {
+        const ssize_t size = send(fd, connection.response.data() + connection.sent,
+                                  connection.response.size() - connection.sent, MSG_NOSIGNAL);
+        if (size < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                close(fd);
+            return;
+        }
+        connection.sent += size;
+    }
+
+    close(fd);
+}
+
+void HttpServer::close(const int fd) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    connections.erase(fd);
+}
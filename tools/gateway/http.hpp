@@ -0,0 +1,76 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__GATEWAY__HTTP__H
+#define STATION_MGMT__GATEWAY__HTTP__H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <map>
+#include <string>
+
+#define HTTP_REQUEST_MAX_SIZE 4096
+
+// Fills the body for a GET path and returns the status code
+using HttpHandler = std::function<int(const std::string& path, std::string& body)>;
+
+// Minimal non-blocking HTTP/1.0 server for JSON GETs, driven by the gateway epoll loop
+class HttpServer {
+    public:
+
+        explicit HttpServer(HttpHandler handler);
+
+        ~HttpServer();
+
+        bool begin(uint16_t port, int epollFd);
+
+        [[nodiscard]]
+        bool owns(int fd) const;
+
+        void handle(int fd, uint32_t events);
+
+    private:
+
+        struct Connection {
+            std::string request;
+            std::string response;
+            size_t sent;
+        };
+
+        HttpHandler handler;
+        int listenFd;
+        int epollFd;
+        std::map<int, Connection> connections;
+
+        void accept();
+
+        void receive(int fd, Connection& connection);
+
+        void respond(int fd, Connection& connection);
+
+        void transmit(int fd, Connection& connection);
+
+        void close(int fd);
+};
+
+#endif
@@ -0,0 +1,317 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "station.hpp"
+
+#include <arpa/inet.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <vector>
+
+
+// The cycle opens with a TIME_SYNC when one is due
+static const char POLL_CYCLE[] = {PROTOCOL_TIME_SYNC, PROTOCOL_TELEMETRY, PROTOCOL_STATUS, PROTOCOL_METEO};
+
+static uint64_t wallClock() {
+    timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return now.tv_sec * 1000ULL + now.tv_nsec / 1000000;
+}
+
+static void appendf(std::string& out, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+static void appendf(std::string& out, const char* format, ...) {
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    out += buffer;
+}
+
+static void telemetryToJson(std::string& out, const Telemetry& telemetry) {
+    appendf(out,
+            "\"panelVoltage\":%.2f,\"panelCurrent\":%.2f,\"batteryVoltage\":%.2f,"
+            "\"batteryChargeCurrent\":%.2f,\"globalStatus\":%s,\"batteryVoltageFiltered\":%.3f",
+            telemetry.panelVoltage, telemetry.panelCurrent, telemetry.batteryVoltage,
+            telemetry.batteryChargeCurrent, telemetry.globalStatus ? "true" : "false",
+            telemetry.batteryVoltageFiltered);
+}
+
+Station::Station(const std::string& name, const sockaddr_in& address, const size_t historySize) {
+    this->name = name;
+    this->address = address;
+    this->historySize = historySize;
+
+    interval = 0;
+    nextCycle = 0;
+    cycleStep = 0;
+
+    pending = false;
+    pendingSequence = 0;
+    pendingOpcode = '\0';
+    pendingSince = 0;
+
+    telemetry = {};
+    telemetryTime = 0;
+    status = {};
+    statusTime = 0;
+    meteo = {};
+    meteoTime = 0;
+
+    nextSync = 0;
+    clockSynced = false;
+    clockDrift = 0.0f;
+    clockEstimate = {0, 0};
+    pendingCorrection = 0;
+
+    requests = 0;
+    responses = 0;
+    timeouts = 0;
+    beacons = 0;
+    consecutiveTimeouts = 0;
+    lastRoundTrip = 0;
+}
+
+const std::string& Station::getName() const {
+    return name;
+}
+
+const sockaddr_in& Station::getAddress() const {
+    return address;
+}
+
+bool Station::isDue(const uint64_t now) const {
+    if (pending)
+        return false;
+
+    // Once a cycle has started its requests follow each other, one in flight at a time
+    return cycleStep > 0 || now >= nextCycle;
+}
+
+bool Station::isPending() const {
+    return pending;
+}
+
+size_t Station::buildRequest(uint8_t* dest, const uint16_t sequence, const uint64_t now) {
+    if (cycleStep == 0 && now < nextSync)
+        cycleStep++;
+
+    pending = true;
+    pendingSequence = sequence;
+    pendingOpcode = POLL_CYCLE[cycleStep];
+    pendingSince = now;
+    requests++;
+
+    dest[0] = PROTOCOL_HEADER;
+    dest[1] = PROTOCOL_VERSION;
+    dest[2] = sequence >> 8;
+    dest[3] = sequence & 0xFF;
+    dest[4] = pendingOpcode;
+
+    if (pendingOpcode != PROTOCOL_TIME_SYNC)
+        return PROTOCOL_HEADER_SIZE + 1;
+
+    // The correction is sent once, the next exchange measures whatever it left
+    std::vector<uint8_t> payload;
+    WireWriter writer(payload);
+    TimeSyncRequest{wallClock(), pendingCorrection}.encode(writer);
+    pendingCorrection = 0;
+    nextSync = now + STATION_SYNC_INTERVAL;
+
+    memcpy(dest + PROTOCOL_HEADER_SIZE + 1, payload.data(), payload.size());
+    return PROTOCOL_HEADER_SIZE + 1 + payload.size();
+}
+
+bool Station::handleResponse(const uint8_t* data, const size_t size, const uint64_t now) {
+    if (!pending || size <= PROTOCOL_HEADER_SIZE || data[0] != PROTOCOL_HEADER || data[1] != PROTOCOL_VERSION)
+        return false;
+
+    const uint16_t sequence = (data[2] << 8) | data[3];
+    if (sequence != pendingSequence)
+        return false;
+
+    const uint8_t* payload = data + PROTOCOL_HEADER_SIZE + 1;
+    const size_t payloadSize = size - PROTOCOL_HEADER_SIZE - 1;
+
+    const char opcode = static_cast<char>(data[PROTOCOL_HEADER_SIZE]);
+    if (opcode == pendingOpcode) {
+        if (opcode == PROTOCOL_TELEMETRY) {
+            Telemetry decoded;
+            if (decodeResponse(payload, payloadSize, decoded) == ClientError::None)
+                pushTelemetry(decoded, now);
+        } else if (opcode == PROTOCOL_STATUS) {
+            Status decoded;
+            if (decodeResponse(payload, payloadSize, decoded) == ClientError::None)
+                pushStatus(decoded, now);
+        } else if (opcode == PROTOCOL_METEO) {
+            if (decodeResponse(payload, payloadSize, meteo) == ClientError::None)
+                meteoTime = now;
+        } else if (opcode == PROTOCOL_TIME_SYNC) {
+            TimeSync decoded;
+            if (decodeResponse(payload, payloadSize, decoded) == ClientError::None)
+                handleTimeSync(decoded, now);
+        }
+    }
+
+    // A NACK still closes the request, the cycle moves on
+    pending = false;
+    responses++;
+    consecutiveTimeouts = 0;
+    lastRoundTrip = now - pendingSince;
+
+    cycleStep++;
+    if (cycleStep == sizeof(POLL_CYCLE)) {
+        cycleStep = 0;
+        nextCycle += interval;
+        if (nextCycle <= now)
+            nextCycle = now + interval;
+    }
+
+    return true;
+}
+
+bool Station::handleBeacon(const uint8_t* data, const size_t size, const uint64_t now) {
+    if (size < 1 || data[0] != PROTOCOL_BEACON)
+        return false;
+
+    Beacon beacon;
+    if (decodeResponse(data + 1, size - 1, beacon) != ClientError::None)
+        return false;
+
+    pushTelemetry(beacon.telemetry, now);
+    pushStatus(beacon.status, now);
+    beacons++;
+    return true;
+}
+
+void Station::checkTimeout(const uint64_t now) {
+    if (!pending || now - pendingSince < STATION_REQUEST_TIMEOUT)
+        return;
+
+    // The rest of the cycle is dropped, a silent station is not hammered with its remaining requests
+    pending = false;
+    timeouts++;
+    if (consecutiveTimeouts < UINT8_MAX)
+        consecutiveTimeouts++;
+
+    cycleStep = 0;
+    nextCycle = now + interval;
+    if (pendingOpcode == PROTOCOL_TIME_SYNC)
+        nextSync = now;
+}
+
+void Station::schedule(const uint64_t start, const uint64_t interval) {
+    this->interval = interval;
+    nextCycle = start;
+}
+
+void Station::toJson(std::string& out, const uint64_t now) const {
+    char host[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &address.sin_addr, host, sizeof(host));
+
+    appendf(out, "{\"name\":\"%s\",\"address\":\"%s:%u\",\"online\":%s,", name.c_str(), host,
+            ntohs(address.sin_port), consecutiveTimeouts < STATION_OFFLINE_TIMEOUTS ? "true" : "false");
+    appendf(out, "\"requests\":%u,\"responses\":%u,\"timeouts\":%u,\"beacons\":%u,\"roundTrip\":%llu,",
+            requests, responses, timeouts, beacons, static_cast<unsigned long long>(lastRoundTrip));
+    appendf(out, "\"clock\":{\"synced\":%s,\"offset\":%lld,\"roundTrip\":%lld,\"drift\":%.1f},",
+            clockSynced ? "true" : "false", static_cast<long long>(clockEstimate.offset),
+            static_cast<long long>(clockEstimate.roundTrip), clockDrift * 1e6f);
+
+    out += "\"telemetry\":";
+    if (telemetryTime > 0) {
+        appendf(out, "{\"age\":%llu,", static_cast<unsigned long long>(now - telemetryTime));
+        telemetryToJson(out, telemetry);
+        out += "},";
+    } else {
+        out += "null,";
+    }
+
+    out += "\"status\":";
+    if (statusTime > 0) {
+        appendf(out,
+                "{\"age\":%llu,\"wrongVoltageIdentification\":%s,\"temperature\":%u,\"battery\":%u,"
+                "\"charging\":%u,\"arrays\":%u,\"load\":%u},",
+                static_cast<unsigned long long>(now - statusTime), status.wrongVoltageIdentification ? "true" : "false",
+                static_cast<unsigned>(status.temperature), static_cast<unsigned>(status.battery),
+                static_cast<unsigned>(status.charging), static_cast<unsigned>(status.arrays),
+                static_cast<unsigned>(status.load));
+    } else {
+        out += "null,";
+    }
+
+    out += "\"meteo\":";
+    if (meteoTime > 0) {
+        appendf(out, "{\"age\":%llu,\"pressure\":%.2f,\"temperature\":%.2f}",
+                static_cast<unsigned long long>(now - meteoTime), meteo.pressure, meteo.temperature);
+    } else {
+        out += "null";
+    }
+
+    out += "}";
+}
+
+void Station::historyToJson(std::string& out) const {
+    out += "[";
+    for (size_t i = 0; i < history.size(); i++) {
+        if (i > 0)
+            out += ",";
+        appendf(out, "{\"time\":%llu,", static_cast<unsigned long long>(history[i].time));
+        telemetryToJson(out, history[i].telemetry);
+        out += "}";
+    }
+    out += "]";
+}
+
+void Station::pushTelemetry(const Telemetry& telemetry, const uint64_t now) {
+    this->telemetry = telemetry;
+    telemetryTime = now;
+
+    if (historySize == 0)
+        return;
+
+    if (history.size() == historySize)
+        history.pop_front();
+    // The station stamps its samples once synced, the time of arrival would add the polling delay
+    history.push_back({isWallTime(telemetry.timestamp) ? telemetry.timestamp : wallClock(), telemetry});
+}
+
+void Station::pushStatus(const Status& status, const uint64_t now) {
+    this->status = status;
+    statusTime = now;
+}
+
+void Station::handleTimeSync(const TimeSync& sync, const uint64_t now) {
+    clockSynced = sync.synced;
+    clockDrift = sync.drift;
+    clockEstimate = estimateClock(sync, wallClock());
+
+    // A slow exchange likely waited in the station receive buffer, its offset is only worth a first sync
+    if (!clockSynced || clockEstimate.roundTrip <= STATION_SYNC_ROUND_TRIP_MAX)
+        pendingCorrection = clockEstimate.offset;
+
+    // The first correction goes out with the next cycle, later ones wait for the regular sync
+    if (!clockSynced)
+        nextSync = now;
+}
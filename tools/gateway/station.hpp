@@ -0,0 +1,120 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__GATEWAY__STATION__H
+#define STATION_MGMT__GATEWAY__STATION__H
+
+#include <netinet/in.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <deque>
+#include <string>
+
+#include "client.hpp"
+
+#define STATION_REQUEST_TIMEOUT 1000
+#define STATION_OFFLINE_TIMEOUTS 3
+#define STATION_SYNC_INTERVAL 60000
+#define STATION_SYNC_ROUND_TRIP_MAX 100
+
+struct Sample {
+    uint64_t time;
+    Telemetry telemetry;
+};
+
+// One polled controller: the request in flight, the latest decoded values and the telemetry history
+class Station {
+    public:
+
+        Station(const std::string& name, const sockaddr_in& address, size_t historySize);
+
+        [[nodiscard]]
+        const std::string& getName() const;
+
+        [[nodiscard]]
+        const sockaddr_in& getAddress() const;
+
+        [[nodiscard]]
+        bool isDue(uint64_t now) const;
+
+        [[nodiscard]]
+        bool isPending() const;
+
+        size_t buildRequest(uint8_t* dest, uint16_t sequence, uint64_t now);
+
+        bool handleResponse(const uint8_t* data, size_t size, uint64_t now);
+
+        bool handleBeacon(const uint8_t* data, size_t size, uint64_t now);
+
+        void checkTimeout(uint64_t now);
+
+        void schedule(uint64_t start, uint64_t interval);
+
+        void toJson(std::string& out, uint64_t now) const;
+
+        void historyToJson(std::string& out) const;
+
+    private:
+
+        std::string name;
+        sockaddr_in address;
+
+        uint64_t interval;
+        uint64_t nextCycle;
+        uint8_t cycleStep;
+
+        bool pending;
+        uint16_t pendingSequence;
+        char pendingOpcode;
+        uint64_t pendingSince;
+
+        Telemetry telemetry;
+        uint64_t telemetryTime;
+        Status status;
+        uint64_t statusTime;
+        Meteo meteo;
+        uint64_t meteoTime;
+
+        uint64_t nextSync;
+        bool clockSynced;
+        float clockDrift;
+        ClockEstimate clockEstimate;
+        int64_t pendingCorrection;
+
+        std::deque<Sample> history;
+        size_t historySize;
+
+        uint32_t requests;
+        uint32_t responses;
+        uint32_t timeouts;
+        uint32_t beacons;
+        uint8_t consecutiveTimeouts;
+        uint64_t lastRoundTrip;
+
+        void pushTelemetry(const Telemetry& telemetry, uint64_t now);
+
+        void pushStatus(const Status& status, uint64_t now);
+
+        void handleTimeSync(const TimeSync& sync, uint64_t now);
+};
+
+#endif
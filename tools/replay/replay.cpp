@@ -0,0 +1,538 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <getopt.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "host.hpp"
+#include "protocol.hpp"
+#include "sdlog.hpp"
+#include "sensors.hpp"
+#include "trace.hpp"
+#include "utils.hpp"
+
+#define REPLAY_DEFAULT_TICK 1000
+#define REPLAY_DEFAULT_TAIL 2000
+
+using Clock = std::chrono::steady_clock;
+
+void setup();
+
+void loop();
+
+struct Frame {
+    TraceRecord type;
+    uint32_t timestamp;
+    std::vector<uint8_t> payload;
+};
+
+struct Decoded {
+    std::vector<Frame> frames;
+    size_t crcErrors = 0;
+    size_t skippedBytes = 0;
+};
+
+struct Reading {
+    uint32_t timestamp;
+    float values[SENSORS_MAX_CHANNELS];
+};
+
+struct ModbusResponse {
+    uint8_t result;
+    std::vector<uint16_t> registers;
+};
+
+struct Injection {
+    uint32_t timestamp;
+    HostDatagram datagram;
+};
+
+struct CommandStats {
+    size_t count = 0;
+    size_t answered = 0;
+    double hostTotal = 0;
+    double hostMax = 0;
+    double latencyTotal = 0;
+    double latencyMax = 0;
+};
+
+template <typename T>
+T readValue(const uint8_t* data) {
+    T value;
+    memcpy(&value, data, sizeof(T));
+    swapEndianness(&value, sizeof(T));
+    return value;
+}
+
+// Serves the recorded readings of one sensor as they become due on the virtual clock
+class ReplaySensor : public SensorDriver {
+    public:
+
+        ReplaySensor(const SensorType type, const uint8_t channels, const SensorQuantity* quantities) {
+            this->type = type;
+            this->channels = channels;
+            memcpy(this->quantities, quantities, sizeof(this->quantities));
+        }
+
+        void push(const Reading& reading) {
+            readings.push_back(reading);
+        }
+
+        void init() override {}
+
+        bool startConversion() override {
+            return true;
+        }
+
+        bool isReady() override {
+            return !readings.empty() && readings.front().timestamp <= millis();
+        }
+
+        uint8_t read(float* values) override {
+            // Catch up with readings the firmware did not poll in time, the latest one wins
+            while (readings.size() > 1 && readings[1].timestamp <= millis())
+                readings.pop_front();
+
+            memcpy(values, readings.front().values, channels * sizeof(float));
+            readings.pop_front();
+            return channels;
+        }
+
+        [[nodiscard]]
+        SensorType getType() const override {
+            return type;
+        }
+
+        [[nodiscard]]
+        uint8_t getChannelCount() const override {
+            return channels;
+        }
+
+        [[nodiscard]]
+        SensorQuantity getQuantity(const uint8_t channel) const override {
+            return quantities[channel];
+        }
+
+    private:
+
+        SensorType type;
+        uint8_t channels;
+        SensorQuantity quantities[SENSORS_MAX_CHANNELS] = {};
+        std::deque<Reading> readings;
+};
+
+static Decoded decode(const std::vector<uint8_t>& data) {
+    Decoded decoded;
+    size_t i = 0;
+
+    // Anything between frames (boot banner, block padding, line noise) is skipped until the next valid sync
+    while (i + TRACE_HEADER_SIZE + TRACE_CRC_SIZE <= data.size()) {
+        if (readValue<uint16_t>(&data[i]) != TRACE_SYNC) {
+            i++;
+            decoded.skippedBytes++;
+            continue;
+        }
+
+        const size_t payloadSize = data[i + 3];
+        const size_t frameSize = TRACE_HEADER_SIZE + payloadSize + TRACE_CRC_SIZE;
+        if (i + frameSize > data.size())
+            break;
+
+        const uint16_t crc = crc16(&data[i + 2], TRACE_HEADER_SIZE - 2 + payloadSize);
+        if (crc != readValue<uint16_t>(&data[i + TRACE_HEADER_SIZE + payloadSize])) {
+            decoded.crcErrors++;
+            i++;
+            decoded.skippedBytes++;
+            continue;
+        }
+
+        Frame frame;
+        frame.type = static_cast<TraceRecord>(data[i + 2]);
+        frame.timestamp = readValue<uint32_t>(&data[i + 4]);
+        frame.payload.assign(data.begin() + i + TRACE_HEADER_SIZE, data.begin() + i + TRACE_HEADER_SIZE + payloadSize);
+        decoded.frames.push_back(frame);
+
+        i += frameSize;
+    }
+
+    decoded.skippedBytes += data.size() - i;
+    return decoded;
+}
+
+static char getOpcode(const std::vector<uint8_t>& data) {
+    if (data.size() > PROTOCOL_HEADER_SIZE && data[0] == PROTOCOL_HEADER)
+        return static_cast<char>(data[PROTOCOL_HEADER_SIZE]);
+
+    return data.empty() ? '\0' : static_cast<char>(data[0]);
+}
+
+static uint64_t fnv1a(uint64_t hash, const void* data, const size_t size) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+static void usage(const char* name) {
+    fprintf(stderr,
+            "Usage: %s [-x speed] [-t tick_us] [-b boot] [-a tail_ms] [-e eeprom.bin] [-o responses.txt] [-v] trace.bin\n",
+            name);
+}
+
+int main(int argc, char** argv) {
+    double speed = 0;
+    unsigned long tick = REPLAY_DEFAULT_TICK;
+    unsigned long tail = REPLAY_DEFAULT_TAIL;
+    size_t boot = 0;
+    const char* eepromPath = nullptr;
+    const char* responsesPath = nullptr;
+
+    int option;
+    while ((option = getopt(argc, argv, "x:t:b:a:e:o:vh")) != -1) {
+        switch (option) {
+            case 'x':
+                speed = strtod(optarg, nullptr);
+                break;
+            case 't':
+                tick = strtoul(optarg, nullptr, 0);
+                break;
+            case 'b':
+                boot = strtoul(optarg, nullptr, 0);
+                break;
+            case 'a':
+                tail = strtoul(optarg, nullptr, 0);
+                break;
+            case 'e':
+                eepromPath = optarg;
+                break;
+            case 'o':
+                responsesPath = optarg;
+                break;
+            case 'v':
+                hostSetSerialEcho(true);
+                break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+
+    if (optind != argc - 1 || tick == 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    FILE* traceFile = fopen(argv[optind], "rb");
+    if (traceFile == nullptr) {
+        perror(argv[optind]);
+        return 2;
+    }
+
+    std::vector<uint8_t> data;
+    uint8_t chunk[4096];
+    size_t chunkSize;
+    while ((chunkSize = fread(chunk, 1, sizeof(chunk), traceFile)) > 0)
+        data.insert(data.end(), chunk, chunk + chunkSize);
+    fclose(traceFile);
+
+    const Decoded decoded = decode(data);
+
+    // A Boot record starts a new timebase, only one boot segment is replayed
+    std::vector<std::vector<Frame>> segments(1);
+    for (const Frame& frame : decoded.frames) {
+        if (frame.type == TraceRecord::Boot && !segments.back().empty())
+            segments.emplace_back();
+        segments.back().push_back(frame);
+    }
+
+    printf("Trace: %zu frames, %zu CRC errors, %zu bytes skipped, %zu boot segments\n",
+           decoded.frames.size(), decoded.crcErrors, decoded.skippedBytes, segments.size());
+
+    if (boot >= segments.size()) {
+        fprintf(stderr, "Boot segment %zu not in trace\n", boot);
+        return 2;
+    }
+
+    std::deque<Injection> injections;
+    std::map<uint16_t, std::deque<ModbusResponse>> modbusResponses;
+    std::map<uint8_t, ReplaySensor*> replaySensors;
+    size_t skippedResets = 0;
+    uint32_t lastTimestamp = 0;
+
+    for (const Frame& frame : segments[boot]) {
+        const std::vector<uint8_t>& payload = frame.payload;
+        lastTimestamp = frame.timestamp;
+
+        switch (frame.type) {
+            case TraceRecord::Boot:
+                if (payload.size() >= 2)
+                    printf("Segment %zu: trace version %u, reset cause 0x%02X, firmware %.*s\n",
+                           boot, payload[0], payload[1], static_cast<int>(payload.size() - 2), &payload[2]);
+                break;
+
+            case TraceRecord::Datagram:
+                {
+                    if (payload.size() < 6)
+                        break;
+
+                    Injection injection;
+                    injection.timestamp = frame.timestamp;
+                    injection.datagram.ip = IPAddress(payload[0], payload[1], payload[2], payload[3]);
+                    injection.datagram.port = readValue<uint16_t>(&payload[4]);
+                    injection.datagram.data.assign(payload.begin() + 6, payload.end());
+
+                    // A reset would end the host process, the rest of the segment still replays
+                    if (getOpcode(injection.datagram.data) == PROTOCOL_RESET) {
+                        skippedResets++;
+                        break;
+                    }
+
+                    injections.push_back(injection);
+                }
+                break;
+
+            case TraceRecord::Modbus:
+                {
+                    if (payload.size() < 4)
+                        break;
+
+                    ModbusResponse response;
+                    response.result = payload[2];
+                    const uint8_t count = payload[3];
+                    for (size_t i = 0; i < count && 4 + i * 2 + 1 < payload.size(); i++)
+                        response.registers.push_back(readValue<uint16_t>(&payload[4 + i * 2]));
+
+                    modbusResponses[readValue<uint16_t>(&payload[0])].push_back(response);
+                }
+                break;
+
+            case TraceRecord::Sensor:
+                {
+                    if (payload.size() < 3)
+                        break;
+
+                    const uint8_t id = payload[0];
+                    const uint8_t channels = payload[2] < SENSORS_MAX_CHANNELS ? payload[2] : SENSORS_MAX_CHANNELS;
+                    if (payload.size() < 3 + channels * 5U)
+                        break;
+
+                    SensorQuantity quantities[SENSORS_MAX_CHANNELS] = {};
+                    Reading reading = {};
+                    reading.timestamp = frame.timestamp;
+                    for (uint8_t channel = 0; channel < channels; channel++) {
+                        quantities[channel] = static_cast<SensorQuantity>(payload[3 + channel * 5]);
+                        reading.values[channel] = readValue<float>(&payload[4 + channel * 5]);
+                    }
+
+                    if (replaySensors.count(id) == 0)
+                        replaySensors[id] = new ReplaySensor(static_cast<SensorType>(payload[1]), channels, quantities);
+                    replaySensors[id]->push(reading);
+                }
+                break;
+        }
+    }
+
+#ifdef SENSORS_ENABLED
+    // Registered ahead of setup(), so ids match the ones the recording firmware assigned
+    Sensors* sensors = Sensors::getInstance();
+    for (uint8_t id = 0; replaySensors.count(id) > 0; id++)
+        sensors->add(replaySensors[id]);
+    if (sensors->getCount() != replaySensors.size())
+        fprintf(stderr, "Sensor ids are not contiguous, only the first %u are replayed\n", sensors->getCount());
+#endif
+
+    if (eepromPath != nullptr && !hostLoadEeprom(eepromPath)) {
+        perror(eepromPath);
+        return 2;
+    }
+
+    // The SD logger writes into a scratch directory unless the caller picked one
+    char sdDirectory[] = "/tmp/replay-sd-XXXXXX";
+    const bool sdScratch = getenv(SD_LOGGER_HOST_DIRECTORY_ENV) == nullptr && mkdtemp(sdDirectory) != nullptr;
+    if (sdScratch)
+        setenv(SD_LOGGER_HOST_DIRECTORY_ENV, sdDirectory, 0);
+
+    FILE* responsesFile = nullptr;
+    if (responsesPath != nullptr) {
+        responsesFile = fopen(responsesPath, "w");
+        if (responsesFile == nullptr) {
+            perror(responsesPath);
+            return 2;
+        }
+    }
+
+    size_t modbusServed = 0;
+    size_t modbusMissing = 0;
+    hostSetModbusHook([&](const uint16_t address, const uint16_t count, uint16_t* registers) -> uint8_t {
+        std::deque<ModbusResponse>& queue = modbusResponses[address];
+        if (queue.empty()) {
+            modbusMissing++;
+            return 0xE2;
+        }
+
+        const ModbusResponse response = queue.front();
+        queue.pop_front();
+        modbusServed++;
+
+        for (uint16_t i = 0; i < count; i++)
+            registers[i] = i < response.registers.size() ? response.registers[i] : 0;
+        return response.result;
+    });
+
+    std::deque<uint32_t> queuedTimestamps;
+    std::map<char, CommandStats> commands;
+    CommandStats* pending = nullptr;
+    uint32_t pendingTimestamp = 0;
+    HostDatagram pendingSource;
+    bool received = false;
+    char receivedOpcode = '\0';
+
+    hostSetReceiveHook([&](const HostDatagram& datagram) {
+        receivedOpcode = getOpcode(datagram.data);
+        pending = &commands[receivedOpcode];
+        pending->count++;
+        pendingTimestamp = queuedTimestamps.front();
+        queuedTimestamps.pop_front();
+        pendingSource = datagram;
+        received = true;
+    });
+
+    uint64_t digest = 0xCBF29CE484222325ULL;
+    size_t sent = 0;
+    hostSetSendHook([&](const HostDatagram& datagram) {
+        const uint32_t now = millis();
+        const uint32_t address = datagram.ip;
+        digest = fnv1a(digest, &now, sizeof(now));
+        digest = fnv1a(digest, &address, sizeof(address));
+        digest = fnv1a(digest, &datagram.port, sizeof(datagram.port));
+        digest = fnv1a(digest, datagram.data.data(), datagram.data.size());
+        sent++;
+
+        if (pending != nullptr && datagram.ip == pendingSource.ip && datagram.port == pendingSource.port) {
+            const double latency = now - pendingTimestamp;
+            pending->answered++;
+            pending->latencyTotal += latency;
+            if (latency > pending->latencyMax)
+                pending->latencyMax = latency;
+            pending = nullptr;
+        }
+
+        if (responsesFile != nullptr) {
+            fprintf(responsesFile, "%u %u.%u.%u.%u:%u ", now, datagram.ip[0], datagram.ip[1], datagram.ip[2],
+                    datagram.ip[3], datagram.port);
+            for (const uint8_t value : datagram.data)
+                fprintf(responsesFile, "%02X", value);
+            fputc('\n', responsesFile);
+        }
+    });
+
+    setup();
+
+    const uint64_t replayStart = hostGetMicros();
+    const uint64_t replayEnd = (static_cast<uint64_t>(lastTimestamp) + tail) * 1000;
+    const Clock::time_point wallStart = Clock::now();
+
+    size_t injected = 0;
+    size_t passes = 0;
+    double loopTotal = 0;
+    double loopMax = 0;
+
+    while (hostGetMicros() < replayEnd) {
+        while (!injections.empty() && injections.front().timestamp * 1000ULL <= hostGetMicros()) {
+            hostInjectDatagram(injections.front().datagram);
+            queuedTimestamps.push_back(injections.front().timestamp);
+            injections.pop_front();
+            injected++;
+        }
+
+        received = false;
+        const Clock::time_point loopStart = Clock::now();
+        loop();
+        const double loopTime = std::chrono::duration<double, std::micro>(Clock::now() - loopStart).count();
+
+        passes++;
+        loopTotal += loopTime;
+        if (loopTime > loopMax)
+            loopMax = loopTime;
+
+        if (received) {
+            CommandStats& stats = commands[receivedOpcode];
+            stats.hostTotal += loopTime;
+            if (loopTime > stats.hostMax)
+                stats.hostMax = loopTime;
+        }
+
+        hostAdvanceMicros(tick);
+
+        if (speed > 0) {
+            const auto elapsed = std::chrono::duration<double, std::micro>((hostGetMicros() - replayStart) / speed);
+            std::this_thread::sleep_until(wallStart + std::chrono::duration_cast<Clock::duration>(elapsed));
+        }
+    }
+
+    const double wallTime = std::chrono::duration<double>(Clock::now() - wallStart).count();
+    const double virtualTime = (hostGetMicros() - replayStart) / 1e6;
+
+    if (responsesFile != nullptr)
+        fclose(responsesFile);
+
+    printf("Replayed %.1f s of traffic in %.3f s (%.0fx), %zu loop passes, %.2f us mean, %.2f us max\n",
+           virtualTime, wallTime, wallTime > 0 ? virtualTime / wallTime : 0, passes,
+           passes > 0 ? loopTotal / passes : 0, loopMax);
+    printf("Datagrams: %zu injected, %zu skipped resets, %zu still queued, %zu sent\n",
+           injected, skippedResets, hostGetQueuedDatagrams(), sent);
+    printf("Modbus: %zu responses served, %zu missing\n", modbusServed, modbusMissing);
+    printf("Throughput: %.0f requests/s of loop time\n", loopTotal > 0 ? injected / (loopTotal / 1e6) : 0);
+
+    printf("\n%-8s %8s %8s %14s %14s %14s %14s\n",
+           "opcode", "count", "answered", "host mean us", "host max us", "latency ms", "latency max");
+    for (const auto& [opcode, stats] : commands) {
+        printf("%-8c %8zu %8zu %14.2f %14.2f %14.1f %14.1f\n",
+               opcode, stats.count, stats.answered,
+               stats.count > 0 ? stats.hostTotal / stats.count : 0, stats.hostMax,
+               stats.answered > 0 ? stats.latencyTotal / stats.answered : 0, stats.latencyMax);
+    }
+
+    printf("\nResponse digest: %016llX\n", static_cast<unsigned long long>(digest));
+
+    for (const auto& [id, sensor] : replaySensors)
+        delete sensor;
+
+    if (sdScratch) {
+        std::error_code error;
+        std::filesystem::remove_all(sdDirectory, error);
+    }
+
+    return 0;
+}
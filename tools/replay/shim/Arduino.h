@@ -0,0 +1,146 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__SHIM__ARDUINO__H
+#define STATION_MGMT__SHIM__ARDUINO__H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define DEC 10
+#define HEX 16
+
+#define PROGMEM
+#define PSTR(x) (x)
+#define F(x) (reinterpret_cast<const __FlashStringHelper*>(PSTR(x)))
+
+#define pgm_read_byte(address) (*reinterpret_cast<const uint8_t*>(address))
+#define pgm_read_word(address) (*reinterpret_cast<const uint16_t*>(address))
+#define pgm_read_dword(address) (*reinterpret_cast<const uint32_t*>(address))
+#define pgm_read_float(address) (*reinterpret_cast<const float*>(address))
+#define memcpy_P memcpy
+#define strlen_P strlen
+
+// EEPROM size of the ATmega2560
+#define E2END 0x0FFF
+
+using byte = uint8_t;
+
+class __FlashStringHelper;
+
+unsigned long millis();
+
+unsigned long micros();
+
+void delay(unsigned long ms);
+
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+
+void digitalWrite(uint8_t pin, uint8_t value);
+
+int digitalRead(uint8_t pin);
+
+class Print;
+
+class Printable {
+    public:
+
+        virtual ~Printable() = default;
+
+        virtual size_t printTo(Print& printer) const = 0;
+};
+
+class Print {
+    public:
+
+        virtual ~Print() = default;
+
+        virtual size_t write(uint8_t value) = 0;
+
+        virtual size_t write(const uint8_t* buffer, size_t size);
+
+        size_t print(const __FlashStringHelper* value);
+        size_t print(const char* value);
+        size_t print(char value);
+        size_t print(unsigned char value, int base = DEC);
+        size_t print(int value, int base = DEC);
+        size_t print(unsigned int value, int base = DEC);
+        size_t print(long value, int base = DEC);
+        size_t print(unsigned long value, int base = DEC);
+        size_t print(double value, int digits = 2);
+        size_t print(const Printable& value);
+
+        size_t println();
+        size_t println(const __FlashStringHelper* value);
+        size_t println(const char* value);
+        size_t println(char value);
+        size_t println(unsigned char value, int base = DEC);
+        size_t println(int value, int base = DEC);
+        size_t println(unsigned int value, int base = DEC);
+        size_t println(long value, int base = DEC);
+        size_t println(unsigned long value, int base = DEC);
+        size_t println(double value, int digits = 2);
+        size_t println(const Printable& value);
+
+        virtual void flush();
+
+    private:
+
+        size_t printNumber(unsigned long value, int base);
+};
+
+class Stream : public Print {
+    public:
+
+        virtual int available();
+
+        virtual int read();
+
+        virtual int peek();
+};
+
+class HardwareSerial : public Stream {
+    public:
+
+        void begin(unsigned long baudrate);
+
+        size_t write(uint8_t value) override;
+
+        using Print::write;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial2;
+
+#endif
@@ -0,0 +1,43 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__SHIM__EEPROM__H
+#define STATION_MGMT__SHIM__EEPROM__H
+
+#include <stdint.h>
+
+#include "Arduino.h"
+
+class EEPROMClass {
+    public:
+
+        uint8_t read(int address);
+
+        void write(int address, uint8_t value);
+
+        void update(int address, uint8_t value);
+
+        uint16_t length();
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
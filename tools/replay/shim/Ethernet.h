@@ -0,0 +1,66 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__SHIM__ETHERNET__H
+#define STATION_MGMT__SHIM__ETHERNET__H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Arduino.h"
+#include "IPAddress.h"
+
+class EthernetClass {
+    public:
+
+        static int begin(uint8_t* mac, IPAddress ip, IPAddress dns, IPAddress gateway, IPAddress subnet);
+};
+
+extern EthernetClass Ethernet;
+
+// Receive side of a UDP socket, fed by the replayer through hostInjectDatagram()
+class EthernetUDP {
+    public:
+
+        uint8_t begin(uint16_t port);
+
+        int parsePacket();
+
+        int read(unsigned char* buffer, size_t size);
+
+        int read(char* buffer, size_t size);
+
+        IPAddress remoteIP();
+
+        uint16_t remotePort();
+
+    protected:
+
+        uint8_t sockindex = 0;
+        uint16_t _remaining = 0;
+
+    private:
+
+        IPAddress _remoteIP;
+        uint16_t _remotePort = 0;
+};
+
+#endif
@@ -0,0 +1,60 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__SHIM__IPADDRESS__H
+#define STATION_MGMT__SHIM__IPADDRESS__H
+
+#include <stdint.h>
+
+#include "Arduino.h"
+
+class IPAddress : public Printable {
+    public:
+
+        IPAddress();
+
+        IPAddress(uint8_t first, uint8_t second, uint8_t third, uint8_t fourth);
+
+        IPAddress(uint32_t address);
+
+        IPAddress(const uint8_t* address);
+
+        bool fromString(const char* address);
+
+        operator uint32_t() const;
+
+        uint8_t operator[](int index) const;
+
+        uint8_t& operator[](int index);
+
+        bool operator==(const IPAddress& other) const;
+
+        bool operator!=(const IPAddress& other) const;
+
+        size_t printTo(Print& printer) const override;
+
+    private:
+
+        // Network byte order, as on the target
+        uint8_t bytes[4];
+};
+
+#endif
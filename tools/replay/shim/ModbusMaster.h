@@ -0,0 +1,56 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__SHIM__MODBUSMASTER__H
+#define STATION_MGMT__SHIM__MODBUSMASTER__H
+
+#include <stdint.h>
+
+#include "Arduino.h"
+
+#define MODBUS_SHIM_BUFFER_SIZE 64
+
+// Answers from the replayer through the host Modbus hook instead of Serial2
+class ModbusMaster {
+    public:
+
+        static const uint8_t ku8MBSuccess = 0x00;
+        static const uint8_t ku8MBIllegalDataAddress = 0x02;
+        static const uint8_t ku8MBResponseTimedOut = 0xE2;
+
+        void begin(uint8_t slave, Stream& serial);
+
+        void preTransmission(void (*callback)());
+
+        void postTransmission(void (*callback)());
+
+        uint8_t readInputRegisters(uint16_t address, uint16_t count);
+
+        uint16_t getResponseBuffer(uint8_t index);
+
+    private:
+
+        uint16_t responseBuffer[MODBUS_SHIM_BUFFER_SIZE] = {};
+        void (*preTransmissionCallback)() = nullptr;
+        void (*postTransmissionCallback)() = nullptr;
+};
+
+#endif
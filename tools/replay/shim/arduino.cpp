@@ -0,0 +1,198 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "Arduino.h"
+
+#include "host.hpp"
+
+HardwareSerial Serial;
+HardwareSerial Serial2;
+
+static uint64_t clockMicros = 0;
+static bool serialEcho = false;
+
+uint64_t hostGetMicros() {
+    return clockMicros;
+}
+
+void hostAdvanceMicros(const uint64_t us) {
+    clockMicros += us;
+}
+
+void hostSetSerialEcho(const bool enabled) {
+    serialEcho = enabled;
+}
+
+unsigned long millis() {
+    return static_cast<unsigned long>(clockMicros / 1000);
+}
+
+unsigned long micros() {
+    return static_cast<unsigned long>(clockMicros);
+}
+
+void delay(const unsigned long ms) {
+    clockMicros += ms * 1000ULL;
+}
+
+void delayMicroseconds(const unsigned int us) {
+    clockMicros += us;
+}
+
+void pinMode(uint8_t, uint8_t) {}
+
+void digitalWrite(uint8_t, uint8_t) {}
+
+int digitalRead(uint8_t) {
+    return LOW;
+}
+
+size_t Print::write(const uint8_t* buffer, const size_t size) {
+    size_t written = 0;
+    for (size_t i = 0; i < size; i++)
+        written += write(buffer[i]);
+    return written;
+}
+
+size_t Print::print(const __FlashStringHelper* value) {
+    return print(reinterpret_cast<const char*>(value));
+}
+
+size_t Print::print(const char* value) {
+    return write(reinterpret_cast<const uint8_t*>(value), strlen(value));
+}
+
+size_t Print::print(const char value) {
+    return write(static_cast<uint8_t>(value));
+}
+
+size_t Print::print(const unsigned char value, const int base) {
+    return printNumber(value, base);
+}
+
+size_t Print::print(const int value, const int base) {
+    return print(static_cast<long>(value), base);
+}
+
+size_t Print::print(const unsigned int value, const int base) {
+    return printNumber(value, base);
+}
+
+size_t Print::print(const long value, const int base) {
+    if (value < 0 && base == DEC)
+        return print('-') + printNumber(-static_cast<unsigned long>(value), base);
+
+    return printNumber(static_cast<unsigned long>(value), base);
+}
+
+size_t Print::print(const unsigned long value, const int base) {
+    return printNumber(value, base);
+}
+
+size_t Print::print(const double value, const int digits) {
+    char buffer[48];
+    snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+    return print(buffer);
+}
+
+size_t Print::print(const Printable& value) {
+    return value.printTo(*this);
+}
+
+size_t Print::println() {
+    return print("\r\n");
+}
+
+size_t Print::println(const __FlashStringHelper* value) {
+    return print(value) + println();
+}
+
+size_t Print::println(const char* value) {
+    return print(value) + println();
+}
+
+size_t Print::println(const char value) {
+    return print(value) + println();
+}
+
+size_t Print::println(const unsigned char value, const int base) {
+    return print(value, base) + println();
+}
+
+size_t Print::println(const int value, const int base) {
+    return print(value, base) + println();
+}
+
+size_t Print::println(const unsigned int value, const int base) {
+    return print(value, base) + println();
+}
+
+size_t Print::println(const long value, const int base) {
+    return print(value, base) + println();
+}
+
+size_t Print::println(const unsigned long value, const int base) {
+    return print(value, base) + println();
+}
+
+size_t Print::println(const double value, const int digits) {
+    return print(value, digits) + println();
+}
+
+size_t Print::println(const Printable& value) {
+    return print(value) + println();
+}
+
+void Print::flush() {}
+
+size_t Print::printNumber(unsigned long value, const int base) {
+    char buffer[8 * sizeof(unsigned long) + 1];
+    char* cursor = buffer + sizeof(buffer) - 1;
+    *cursor = '\0';
+
+    do {
+        const unsigned long digit = value % base;
+        *--cursor = static_cast<char>(digit < 10 ? '0' + digit : 'A' + digit - 10);
+        value /= base;
+    } while (value > 0);
+
+    return print(cursor);
+}
+
+int Stream::available() {
+    return 0;
+}
+
+int Stream::read() {
+    return -1;
+}
+
+int Stream::peek() {
+    return -1;
+}
+
+void HardwareSerial::begin(unsigned long) {}
+
+size_t HardwareSerial::write(const uint8_t value) {
+    if (serialEcho && this == &Serial)
+        fputc(value, stderr);
+    return 1;
+}
@@ -0,0 +1,68 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "EEPROM.h"
+
+#include "host.hpp"
+
+EEPROMClass EEPROM;
+
+// Starts erased, like a factory fresh part
+static uint8_t memory[E2END + 1] = {};
+static bool erased = false;
+
+static void erase() {
+    if (erased)
+        return;
+
+    memset(memory, 0xFF, sizeof(memory));
+    erased = true;
+}
+
+bool hostLoadEeprom(const char* path) {
+    erase();
+
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr)
+        return false;
+
+    fread(memory, 1, sizeof(memory), file);
+    fclose(file);
+    return true;
+}
+
+uint8_t EEPROMClass::read(const int address) {
+    erase();
+    return memory[address & E2END];
+}
+
+void EEPROMClass::write(const int address, const uint8_t value) {
+    erase();
+    memory[address & E2END] = value;
+}
+
+void EEPROMClass::update(const int address, const uint8_t value) {
+    write(address, value);
+}
+
+uint16_t EEPROMClass::length() {
+    return E2END + 1;
+}
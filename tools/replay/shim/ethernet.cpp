@@ -0,0 +1,191 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "Ethernet.h"
+
+#include <deque>
+
+#include "SPI.h"
+#include "host.hpp"
+#include "utility/w5100.h"
+
+#define W5100_TX_BASE 0x4000
+#define W5100_MEMORY_SIZE 0x8000
+
+struct HostSocket {
+    uint16_t txWrite;
+    uint16_t txSent;
+    uint8_t interrupts;
+    uint8_t destination[4];
+    uint16_t port;
+};
+
+EthernetClass Ethernet;
+W5100Class W5100;
+SPIClass SPI;
+
+static uint8_t memory[W5100_MEMORY_SIZE];
+static HostSocket sockets[W5100_SOCKETS];
+
+static std::deque<HostDatagram> receiveQueue;
+static std::vector<uint8_t> receiveCurrent;
+static HostDatagramHook receiveHook;
+static HostDatagramHook sendHook;
+
+void hostInjectDatagram(const HostDatagram& datagram) {
+    receiveQueue.push_back(datagram);
+}
+
+size_t hostGetQueuedDatagrams() {
+    return receiveQueue.size();
+}
+
+void hostSetReceiveHook(HostDatagramHook hook) {
+    receiveHook = std::move(hook);
+}
+
+void hostSetSendHook(HostDatagramHook hook) {
+    sendHook = std::move(hook);
+}
+
+SPISettings::SPISettings(uint32_t, uint8_t, uint8_t) {}
+
+void SPIClass::begin() {}
+
+void SPIClass::beginTransaction(SPISettings) {}
+
+void SPIClass::endTransaction() {}
+
+uint16_t W5100Class::SBASE(const uint8_t socket) {
+    return W5100_TX_BASE + socket * SSIZE;
+}
+
+bool W5100Class::hasOffsetAddressMapping() {
+    return false;
+}
+
+uint16_t W5100Class::write(const uint16_t address, const uint8_t* buffer, const uint16_t size) {
+    for (uint16_t i = 0; i < size; i++)
+        memory[(address + i) % W5100_MEMORY_SIZE] = buffer[i];
+    return size;
+}
+
+uint16_t W5100Class::read(const uint16_t address, uint8_t* buffer, const uint16_t size) {
+    for (uint16_t i = 0; i < size; i++)
+        buffer[i] = memory[(address + i) % W5100_MEMORY_SIZE];
+    return size;
+}
+
+void W5100Class::execCmdSn(const uint8_t socket, const SockCMD command) {
+    HostSocket& state = sockets[socket];
+    if (command != Sock_SEND)
+        return;
+
+    HostDatagram datagram;
+    datagram.ip = IPAddress(state.destination);
+    datagram.port = state.port;
+
+    const uint16_t size = state.txWrite - state.txSent;
+    for (uint16_t i = 0; i < size; i++)
+        datagram.data.push_back(memory[SBASE(socket) + ((state.txSent + i) & SMASK)]);
+
+    state.txSent = state.txWrite;
+    state.interrupts |= SnIR::SEND_OK;
+
+    if (sendHook)
+        sendHook(datagram);
+}
+
+uint8_t W5100Class::readSnIR(const uint8_t socket) {
+    return sockets[socket].interrupts;
+}
+
+void W5100Class::writeSnIR(const uint8_t socket, const uint8_t value) {
+    sockets[socket].interrupts &= ~value;
+}
+
+uint16_t W5100Class::readSnTX_WR(const uint8_t socket) {
+    return sockets[socket].txWrite;
+}
+
+void W5100Class::writeSnTX_WR(const uint8_t socket, const uint16_t value) {
+    sockets[socket].txWrite = value;
+}
+
+uint16_t W5100Class::readSnTX_FSR(const uint8_t socket) {
+    return SSIZE - static_cast<uint16_t>(sockets[socket].txWrite - sockets[socket].txSent);
+}
+
+void W5100Class::writeSnDIPR(const uint8_t socket, uint8_t* address) {
+    memcpy(sockets[socket].destination, address, 4);
+}
+
+void W5100Class::writeSnDPORT(const uint8_t socket, const uint16_t port) {
+    sockets[socket].port = port;
+}
+
+int EthernetClass::begin(uint8_t*, IPAddress, IPAddress, IPAddress, IPAddress) {
+    return 1;
+}
+
+uint8_t EthernetUDP::begin(uint16_t) {
+    sockindex = 0;
+    return 1;
+}
+
+int EthernetUDP::parsePacket() {
+    if (receiveQueue.empty())
+        return 0;
+
+    const HostDatagram datagram = receiveQueue.front();
+    receiveQueue.pop_front();
+
+    _remoteIP = datagram.ip;
+    _remotePort = datagram.port;
+    _remaining = datagram.data.size();
+    receiveCurrent = datagram.data;
+
+    if (receiveHook)
+        receiveHook(datagram);
+
+    return _remaining;
+}
+
+int EthernetUDP::read(unsigned char* buffer, size_t size) {
+    if (size > _remaining)
+        size = _remaining;
+
+    memcpy(buffer, receiveCurrent.data(), size);
+    _remaining = 0;
+    return static_cast<int>(size);
+}
+
+int EthernetUDP::read(char* buffer, const size_t size) {
+    return read(reinterpret_cast<unsigned char*>(buffer), size);
+}
+
+IPAddress EthernetUDP::remoteIP() {
+    return _remoteIP;
+}
+
+uint16_t EthernetUDP::remotePort() {
+    return _remotePort;
+}
@@ -0,0 +1,61 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__SHIM__HOST__H
+#define STATION_MGMT__SHIM__HOST__H
+
+#include <stdint.h>
+
+#include <functional>
+#include <vector>
+
+#include "IPAddress.h"
+
+struct HostDatagram {
+    IPAddress ip;
+    uint16_t port;
+    std::vector<uint8_t> data;
+};
+
+using HostDatagramHook = std::function<void(const HostDatagram& datagram)>;
+using HostModbusHook = std::function<uint8_t(uint16_t address, uint16_t count, uint16_t* registers)>;
+
+// Virtual clock behind millis()/micros(), only delay() and the replayer move it
+uint64_t hostGetMicros();
+
+void hostAdvanceMicros(uint64_t us);
+
+void hostSetSerialEcho(bool enabled);
+
+// Queued datagrams are handed out one per parsePacket(), in order
+void hostInjectDatagram(const HostDatagram& datagram);
+
+size_t hostGetQueuedDatagrams();
+
+void hostSetReceiveHook(HostDatagramHook hook);
+
+void hostSetSendHook(HostDatagramHook hook);
+
+void hostSetModbusHook(HostModbusHook hook);
+
+bool hostLoadEeprom(const char* path);
+
+#endif
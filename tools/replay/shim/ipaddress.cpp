@@ -0,0 +1,81 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "IPAddress.h"
+
+IPAddress::IPAddress() : bytes{0, 0, 0, 0} {}
+
+IPAddress::IPAddress(const uint8_t first, const uint8_t second, const uint8_t third, const uint8_t fourth)
+    : bytes{first, second, third, fourth} {}
+
+IPAddress::IPAddress(const uint32_t address) {
+    memcpy(bytes, &address, sizeof(bytes));
+}
+
+IPAddress::IPAddress(const uint8_t* address) {
+    memcpy(bytes, address, sizeof(bytes));
+}
+
+bool IPAddress::fromString(const char* address) {
+    unsigned int parts[4];
+    char tail;
+    if (sscanf(address, "%u.%u.%u.%u%c", &parts[0], &parts[1], &parts[2], &parts[3], &tail) != 4)
+        return false;
+
+    for (uint8_t i = 0; i < 4; i++) {
+        if (parts[i] > 0xFF)
+            return false;
+        bytes[i] = static_cast<uint8_t>(parts[i]);
+    }
+    return true;
+}
+
+IPAddress::operator uint32_t() const {
+    uint32_t address;
+    memcpy(&address, bytes, sizeof(address));
+    return address;
+}
+
+uint8_t IPAddress::operator[](const int index) const {
+    return bytes[index];
+}
+
+uint8_t& IPAddress::operator[](const int index) {
+    return bytes[index];
+}
+
+bool IPAddress::operator==(const IPAddress& other) const {
+    return memcmp(bytes, other.bytes, sizeof(bytes)) == 0;
+}
+
+bool IPAddress::operator!=(const IPAddress& other) const {
+    return !(*this == other);
+}
+
+size_t IPAddress::printTo(Print& printer) const {
+    size_t size = 0;
+    for (uint8_t i = 0; i < 4; i++) {
+        if (i > 0)
+            size += printer.print('.');
+        size += printer.print(bytes[i], DEC);
+    }
+    return size;
+}
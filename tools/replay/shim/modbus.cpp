@@ -0,0 +1,59 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ModbusMaster.h"
+
+#include "host.hpp"
+
+static HostModbusHook modbusHook;
+
+void hostSetModbusHook(HostModbusHook hook) {
+    modbusHook = std::move(hook);
+}
+
+void ModbusMaster::begin(uint8_t, Stream&) {}
+
+void ModbusMaster::preTransmission(void (*callback)()) {
+    preTransmissionCallback = callback;
+}
+
+void ModbusMaster::postTransmission(void (*callback)()) {
+    postTransmissionCallback = callback;
+}
+
+uint8_t ModbusMaster::readInputRegisters(const uint16_t address, uint16_t count) {
+    if (count > MODBUS_SHIM_BUFFER_SIZE)
+        return ku8MBIllegalDataAddress;
+
+    if (preTransmissionCallback != nullptr)
+        preTransmissionCallback();
+    if (postTransmissionCallback != nullptr)
+        postTransmissionCallback();
+
+    if (!modbusHook)
+        return ku8MBResponseTimedOut;
+
+    return modbusHook(address, count, responseBuffer);
+}
+
+uint16_t ModbusMaster::getResponseBuffer(const uint8_t index) {
+    return index < MODBUS_SHIM_BUFFER_SIZE ? responseBuffer[index] : 0xFFFF;
+}
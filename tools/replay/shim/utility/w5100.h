@@ -0,0 +1,82 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__SHIM__W5100__H
+#define STATION_MGMT__SHIM__W5100__H
+
+#include <stdint.h>
+
+#include "SPI.h"
+
+#define SPI_ETHERNET_SETTINGS SPISettings(14000000, MSBFIRST, SPI_MODE0)
+
+#define W5100_SOCKETS 4
+
+enum SockCMD : uint8_t {
+    Sock_OPEN = 0x01,
+    Sock_CLOSE = 0x10,
+    Sock_SEND = 0x20,
+    Sock_RECV = 0x40
+};
+
+class SnIR {
+    public:
+
+        static const uint8_t SEND_OK = 0x10;
+        static const uint8_t TIMEOUT = 0x08;
+        static const uint8_t RECV = 0x04;
+};
+
+// Register level model of the W5100 socket TX path, every SEND completes at once
+class W5100Class {
+    public:
+
+        static const uint16_t SSIZE = 2048;
+        static const uint16_t SMASK = 0x07FF;
+
+        static uint16_t SBASE(uint8_t socket);
+
+        static bool hasOffsetAddressMapping();
+
+        static uint16_t write(uint16_t address, const uint8_t* buffer, uint16_t size);
+
+        static uint16_t read(uint16_t address, uint8_t* buffer, uint16_t size);
+
+        static void execCmdSn(uint8_t socket, SockCMD command);
+
+        static uint8_t readSnIR(uint8_t socket);
+
+        static void writeSnIR(uint8_t socket, uint8_t value);
+
+        static uint16_t readSnTX_WR(uint8_t socket);
+
+        static void writeSnTX_WR(uint8_t socket, uint16_t value);
+
+        static uint16_t readSnTX_FSR(uint8_t socket);
+
+        static void writeSnDIPR(uint8_t socket, uint8_t* address);
+
+        static void writeSnDPORT(uint8_t socket, uint16_t port);
+};
+
+extern W5100Class W5100;
+
+#endif
@@ -0,0 +1,349 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <getopt.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <avr_uart.h>
+#include <sim_avr.h>
+#include <sim_elf.h>
+#include <sim_io.h>
+
+#include "benchmark.hpp"
+#include "bmp280_model.h"
+#include "modbus_model.h"
+#include "w5100_model.h"
+
+#define BENCH_MCU "atmega2560"
+#define BENCH_FREQUENCY 16000000UL
+#define BENCH_RAMEND 0x21FF
+
+#define BENCH_UDP_PORT 8888
+#define BENCH_BMP280_ADDRESS 0x76
+#define BENCH_REQUEST_SIZE 8
+
+#define BENCH_DEFAULT_SECONDS 5
+#define BENCH_DEFAULT_COMMANDS "ptsmygadlo"
+#define BENCH_DEFAULT_INTERVAL_MS 300
+#define BENCH_SETUP_TIMEOUT_SECONDS 30
+#define BENCH_MAX_LIMITS 32
+
+typedef struct {
+    uint64_t calls;
+    uint64_t total;
+    uint64_t min;
+    uint64_t max;
+} bench_stat_t;
+
+typedef struct {
+    char name[32];
+    uint64_t cycles;
+} bench_limit_t;
+
+typedef struct {
+    avr_cycle_count_t begin[256];
+    bench_stat_t sections[256];
+    bench_stat_t commands[256];
+    uint8_t command;
+    int running;
+} bench_t;
+
+static const struct {
+    int id;
+    const char* name;
+} sectionNames[] = {
+#define BENCH_SECTION_NAME(name, id) {id, #name},
+    BENCHMARK_SECTIONS(BENCH_SECTION_NAME)
+#undef BENCH_SECTION_NAME
+};
+
+static bench_t bench;
+
+static void record(bench_stat_t* stat, const uint64_t cycles) {
+    if (stat->calls == 0 || cycles < stat->min)
+        stat->min = cycles;
+    if (cycles > stat->max)
+        stat->max = cycles;
+    stat->total += cycles;
+    stat->calls++;
+}
+
+static void beginHook(avr_t* avr, avr_io_addr_t address, uint8_t value, void* param) {
+    (void) address;
+    (void) param;
+
+    if (value == BENCHMARK_Loop)
+        bench.running = 1;
+    bench.begin[value] = avr->cycle;
+}
+
+static void endHook(avr_t* avr, avr_io_addr_t address, uint8_t value, void* param) {
+    (void) address;
+    (void) param;
+
+    if (!bench.running || bench.begin[value] == 0)
+        return;
+
+    const uint64_t cycles = avr->cycle - bench.begin[value];
+    record(&bench.sections[value], cycles);
+
+    if (value == BENCHMARK_ReceiveCommand && bench.command != 0) {
+        record(&bench.commands[bench.command], cycles);
+        bench.command = 0;
+    }
+
+    bench.begin[value] = 0;
+}
+
+static void commandHook(avr_t* avr, avr_io_addr_t address, uint8_t value, void* param) {
+    (void) avr;
+    (void) address;
+    (void) param;
+
+    bench.command = value;
+}
+
+static const char* sectionName(const int id) {
+    for (size_t i = 0; i < sizeof(sectionNames) / sizeof(sectionNames[0]); i++)
+        if (sectionNames[i].id == id)
+            return sectionNames[i].name;
+    return "?";
+}
+
+static void printStat(const char* name, const bench_stat_t* stat) {
+    const uint64_t average = stat->total / stat->calls;
+    printf(
+        "%-20s %8llu %10llu %10llu %10llu %10.1f\n",
+        name,
+        (unsigned long long) stat->calls,
+        (unsigned long long) stat->min,
+        (unsigned long long) average,
+        (unsigned long long) stat->max,
+        average * 1e6 / BENCH_FREQUENCY);
+}
+
+static int checkLimit(const bench_limit_t* limit) {
+    const bench_stat_t* stat = NULL;
+
+    if (strncmp(limit->name, "cmd:", 4) == 0 && limit->name[4] != '\0') {
+        stat = &bench.commands[(uint8_t) limit->name[4]];
+    } else {
+        for (size_t i = 0; i < sizeof(sectionNames) / sizeof(sectionNames[0]); i++)
+            if (strcmp(sectionNames[i].name, limit->name) == 0)
+                stat = &bench.sections[sectionNames[i].id];
+    }
+
+    if (stat == NULL) {
+        fprintf(stderr, "limit %s: unknown section\n", limit->name);
+        return 0;
+    }
+
+    if (stat->calls == 0) {
+        fprintf(stderr, "limit %s: never executed\n", limit->name);
+        return 0;
+    }
+
+    const uint64_t average = stat->total / stat->calls;
+    if (average > limit->cycles) {
+        fprintf(
+            stderr,
+            "limit %s: average %llu cycles over %llu\n",
+            limit->name,
+            (unsigned long long) average,
+            (unsigned long long) limit->cycles);
+        return 0;
+    }
+
+    return 1;
+}
+
+static void usage(const char* program) {
+    fprintf(
+        stderr,
+        "usage: %s [-s seconds] [-c commands] [-i interval_ms] [-l section=cycles]... [-k stack_bytes] firmware.elf\n"
+        "  -l accepts a section name or cmd:<opcode>, the average must not exceed the limit\n",
+        program);
+}
+
+int main(int argc, char** argv) {
+    unsigned long seconds = BENCH_DEFAULT_SECONDS;
+    unsigned long interval = BENCH_DEFAULT_INTERVAL_MS;
+    const char* commands = BENCH_DEFAULT_COMMANDS;
+    unsigned long stackLimit = 0;
+    bench_limit_t limits[BENCH_MAX_LIMITS];
+    int limitCount = 0;
+
+    int option;
+    while ((option = getopt(argc, argv, "s:c:i:l:k:h")) != -1) {
+        switch (option) {
+            case 's':
+                seconds = strtoul(optarg, NULL, 0);
+                break;
+            case 'c':
+                commands = optarg;
+                break;
+            case 'i':
+                interval = strtoul(optarg, NULL, 0);
+                break;
+            case 'l':
+                {
+                    const char* separator = strchr(optarg, '=');
+                    if (separator == NULL || limitCount == BENCH_MAX_LIMITS) {
+                        usage(argv[0]);
+                        return 2;
+                    }
+                    snprintf(limits[limitCount].name, sizeof(limits[limitCount].name), "%.*s", (int) (separator - optarg), optarg);
+                    limits[limitCount].cycles = strtoull(separator + 1, NULL, 0);
+                    limitCount++;
+                }
+                break;
+            case 'k':
+                stackLimit = strtoul(optarg, NULL, 0);
+                break;
+            default:
+                usage(argv[0]);
+                return option == 'h' ? 0 : 2;
+        }
+    }
+
+    if (optind != argc - 1) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    static elf_firmware_t firmware;
+    if (elf_read_firmware(argv[optind], &firmware) != 0) {
+        fprintf(stderr, "cannot read %s\n", argv[optind]);
+        return 2;
+    }
+
+    avr_t* avr = avr_make_mcu_by_name(BENCH_MCU);
+    if (avr == NULL) {
+        fprintf(stderr, "simavr has no %s core\n", BENCH_MCU);
+        return 2;
+    }
+
+    avr_init(avr);
+    avr_load_firmware(avr, &firmware);
+    avr->frequency = BENCH_FREQUENCY;
+
+    // The console UART would echo the boot banner into the report
+    uint32_t flags = 0;
+    avr_ioctl(avr, AVR_IOCTL_UART_GET_FLAGS('0'), &flags);
+    flags &= ~AVR_UART_FLAG_STDIO;
+    avr_ioctl(avr, AVR_IOCTL_UART_SET_FLAGS('0'), &flags);
+
+    static w5100_t w5100;
+    static modbus_t modbus;
+    static bmp280_t bmp280;
+    w5100_init(avr, &w5100);
+    modbus_init(avr, &modbus, '2');
+    bmp280_init(avr, &bmp280, BENCH_BMP280_ADDRESS);
+
+    avr_register_io_write(avr, BENCHMARK_REGISTER_BEGIN, beginHook, NULL);
+    avr_register_io_write(avr, BENCHMARK_REGISTER_END, endHook, NULL);
+    avr_register_io_write(avr, BENCHMARK_REGISTER_COMMAND, commandHook, NULL);
+
+    const avr_cycle_count_t setupTimeout = (avr_cycle_count_t) BENCH_SETUP_TIMEOUT_SECONDS * BENCH_FREQUENCY;
+    const avr_cycle_count_t intervalCycles = (avr_cycle_count_t) interval * (BENCH_FREQUENCY / 1000);
+    avr_cycle_count_t setupCycles = 0;
+    avr_cycle_count_t endCycle = 0;
+    avr_cycle_count_t nextRequest = 0;
+    size_t nextCommand = 0;
+    uint32_t injected = 0;
+    uint16_t stackPointerMin = BENCH_RAMEND;
+
+    for (;;) {
+        const int state = avr_run(avr);
+        if (state == cpu_Done || state == cpu_Crashed) {
+            fprintf(stderr, "firmware stopped (%s) at pc 0x%05x\n", state == cpu_Done ? "done" : "crashed", avr->pc);
+            return 2;
+        }
+
+        const uint16_t stackPointer = avr->data[R_SPL] | (avr->data[R_SPH] << 8);
+        if (stackPointer < stackPointerMin)
+            stackPointerMin = stackPointer;
+
+        if (!bench.running) {
+            if (avr->cycle > setupTimeout) {
+                fprintf(stderr, "setup did not reach loop() within %d s\n", BENCH_SETUP_TIMEOUT_SECONDS);
+                return 2;
+            }
+            continue;
+        }
+
+        if (endCycle == 0) {
+            setupCycles = avr->cycle;
+            endCycle = avr->cycle + (avr_cycle_count_t) seconds * BENCH_FREQUENCY;
+            nextRequest = avr->cycle;
+        }
+
+        if (avr->cycle >= nextRequest && commands[0] != '\0') {
+            uint8_t request[BENCH_REQUEST_SIZE] = {0};
+            request[0] = commands[nextCommand];
+            injected += w5100_inject_udp(&w5100, BENCH_UDP_PORT, request, sizeof(request));
+            nextCommand = (nextCommand + 1) % strlen(commands);
+            nextRequest += intervalCycles;
+        }
+
+        if (avr->cycle >= endCycle)
+            break;
+    }
+
+    printf("setup: %llu cycles (%.1f ms)\n", (unsigned long long) setupCycles, setupCycles * 1e3 / BENCH_FREQUENCY);
+    printf(
+        "traffic: %u requests, %u datagrams sent, %u modbus replies, %u i2c transfers\n\n",
+        injected,
+        w5100.sends,
+        modbus.requests,
+        bmp280.transfers);
+
+    printf("%-20s %8s %10s %10s %10s %10s\n", "section", "calls", "min", "avg", "max", "avg us");
+    for (int id = 0; id < 256; id++)
+        if (bench.sections[id].calls > 0)
+            printStat(sectionName(id), &bench.sections[id]);
+
+    for (int opcode = 0; opcode < 256; opcode++) {
+        if (bench.commands[opcode].calls == 0)
+            continue;
+        char name[32];
+        snprintf(name, sizeof(name), "command '%c'", opcode);
+        printStat(name, &bench.commands[opcode]);
+    }
+
+    const unsigned long stackPeak = BENCH_RAMEND - stackPointerMin;
+    printf("\npeak stack: %lu bytes (SP min 0x%04x)\n", stackPeak, stackPointerMin);
+
+    int passed = 1;
+    for (int i = 0; i < limitCount; i++)
+        passed &= checkLimit(&limits[i]);
+
+    if (stackLimit > 0 && stackPeak > stackLimit) {
+        fprintf(stderr, "peak stack %lu bytes over %lu\n", stackPeak, stackLimit);
+        passed = 0;
+    }
+
+    avr_terminate(avr);
+    return passed ? 0 : 1;
+}
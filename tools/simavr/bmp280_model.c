@@ -0,0 +1,98 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "bmp280_model.h"
+
+#include <string.h>
+
+#include <avr_twi.h>
+
+// Calibration and raw readings of the worked example in the BMP280 datasheet (25.08 °C, 1006.53 hPa)
+static const uint16_t calibration[] = {
+    27504, 26435, (uint16_t) -1000, 36477, (uint16_t) -10685, 3024, 2855, 140, (uint16_t) -7, 15500, (uint16_t) -14600,
+    6000};
+static const uint32_t rawPressure = 415148;
+static const uint32_t rawTemperature = 519888;
+
+static void twiHook(avr_irq_t* irq, const uint32_t value, void* param) {
+    (void) irq;
+    bmp280_t* bmp280 = (bmp280_t*) param;
+
+    avr_twi_msg_irq_t message;
+    message.u.v = value;
+
+    if (message.u.twi.msg & TWI_COND_STOP)
+        bmp280->selected = 0;
+
+    if (message.u.twi.msg & TWI_COND_START) {
+        bmp280->selected = (message.u.twi.addr >> 1) == bmp280->address;
+        bmp280->pointerSet = 0;
+        if (bmp280->selected) {
+            bmp280->transfers++;
+            avr_raise_irq(bmp280->irq + TWI_IRQ_INPUT, avr_twi_irq_msg(TWI_COND_ACK, message.u.twi.addr, 1));
+        }
+    }
+
+    if (!bmp280->selected)
+        return;
+
+    if (message.u.twi.msg & TWI_COND_WRITE) {
+        avr_raise_irq(bmp280->irq + TWI_IRQ_INPUT, avr_twi_irq_msg(TWI_COND_ACK, message.u.twi.addr, 1));
+
+        // Writes alternate register and value, only the register pointer matters to the model
+        if (!bmp280->pointerSet) {
+            bmp280->pointer = message.u.twi.data;
+            bmp280->pointerSet = 1;
+        } else {
+            bmp280->pointerSet = 0;
+        }
+    }
+
+    if (message.u.twi.msg & TWI_COND_READ) {
+        const uint8_t data = bmp280->registers[bmp280->pointer++];
+        avr_raise_irq(bmp280->irq + TWI_IRQ_INPUT, avr_twi_irq_msg(TWI_COND_READ, message.u.twi.addr, data));
+    }
+}
+
+void bmp280_init(avr_t* avr, bmp280_t* bmp280, const uint8_t address) {
+    static const char* names[] = {"bmp280.in", "bmp280.out"};
+
+    memset(bmp280, 0, sizeof(bmp280_t));
+    bmp280->address = address;
+
+    bmp280->registers[0xD0] = 0x58;
+    for (size_t i = 0; i < sizeof(calibration) / sizeof(calibration[0]); i++) {
+        bmp280->registers[0x88 + i * 2] = calibration[i] & 0xFF;
+        bmp280->registers[0x88 + i * 2 + 1] = calibration[i] >> 8;
+    }
+    bmp280->registers[0xF7] = rawPressure >> 12;
+    bmp280->registers[0xF8] = (rawPressure >> 4) & 0xFF;
+    bmp280->registers[0xF9] = (rawPressure & 0x0F) << 4;
+    bmp280->registers[0xFA] = rawTemperature >> 12;
+    bmp280->registers[0xFB] = (rawTemperature >> 4) & 0xFF;
+    bmp280->registers[0xFC] = (rawTemperature & 0x0F) << 4;
+
+    bmp280->irq = avr_alloc_irq(&avr->irq_pool, 0, 2, names);
+
+    avr_irq_register_notify(bmp280->irq + TWI_IRQ_OUTPUT, twiHook, bmp280);
+    avr_connect_irq(avr_io_getirq(avr, AVR_IOCTL_TWI_GETIRQ(0), TWI_IRQ_OUTPUT), bmp280->irq + TWI_IRQ_OUTPUT);
+    avr_connect_irq(bmp280->irq + TWI_IRQ_INPUT, avr_io_getirq(avr, AVR_IOCTL_TWI_GETIRQ(0), TWI_IRQ_INPUT));
+}
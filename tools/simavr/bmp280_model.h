@@ -0,0 +1,41 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__BMP280_MODEL__H
+#define STATION_MGMT__BMP280_MODEL__H
+
+#include <stdint.h>
+
+#include <sim_avr.h>
+
+typedef struct {
+    avr_irq_t* irq;
+    uint8_t address;
+    uint8_t registers[256];
+    uint8_t pointer;
+    int selected;
+    int pointerSet;
+    uint32_t transfers;
+} bmp280_t;
+
+void bmp280_init(avr_t* avr, bmp280_t* bmp280, uint8_t address);
+
+#endif
@@ -0,0 +1,139 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "modbus_model.h"
+
+#include <string.h>
+
+#include <avr_uart.h>
+
+#define MODBUS_READ_INPUT_REGISTERS 0x04
+
+// A charging controller at noon: PV 18.00 V 1.50 A, battery 13.10 V charging at 1.20 A, 0.50 A on the load output
+static const struct {
+    uint16_t address;
+    uint16_t value;
+} registers[] = {
+    {0x3100, 1800},
+    {0x3101, 150},
+    {0x3102, 2700},
+    {0x3103, 0},
+    {0x3104, 1310},
+    {0x3105, 120},
+    {0x3106, 1572},
+    {0x3107, 0},
+    {0x310C, 1310},
+    {0x310D, 50},
+    {0x310E, 655},
+    {0x310F, 0},
+    {0x3110, 2450},
+    {0x3111, 3120},
+    {0x311A, 82},
+    {0x3200, 0x0000},
+    {0x3201, 0x0008},
+    {0x3202, 0x0000},
+    {0x3300, 2140},
+    {0x3301, 0},
+    {0x3302, 1380},
+    {0x3303, 1240},
+    {0x3304, 12},
+    {0x330C, 35},
+    {0x3312, 48210},
+    {0x331B, 70},
+    {0x331C, 0},
+};
+
+static uint16_t crc16(const uint8_t* data, const uint16_t size) {
+    uint16_t crc = 0xFFFF;
+    for (uint16_t i = 0; i < size; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++)
+            crc = crc & 1 ? (crc >> 1) ^ 0xA001 : crc >> 1;
+    }
+    return crc;
+}
+
+static uint16_t readRegister(const uint16_t address) {
+    for (size_t i = 0; i < sizeof(registers) / sizeof(registers[0]); i++)
+        if (registers[i].address == address)
+            return registers[i].value;
+    return 0;
+}
+
+static void respond(modbus_t* modbus) {
+    const uint16_t start = (modbus->frame[2] << 8) | modbus->frame[3];
+    uint16_t count = (modbus->frame[4] << 8) | modbus->frame[5];
+    if (count > MODBUS_MAX_REGISTERS)
+        count = MODBUS_MAX_REGISTERS;
+
+    uint8_t response[5 + MODBUS_MAX_REGISTERS * 2];
+    uint16_t size = 0;
+    response[size++] = modbus->frame[0];
+    response[size++] = MODBUS_READ_INPUT_REGISTERS;
+    response[size++] = count * 2;
+    for (uint16_t i = 0; i < count; i++) {
+        const uint16_t value = readRegister(start + i);
+        response[size++] = value >> 8;
+        response[size++] = value & 0xFF;
+    }
+
+    const uint16_t crc = crc16(response, size);
+    response[size++] = crc & 0xFF;
+    response[size++] = crc >> 8;
+
+    for (uint16_t i = 0; i < size; i++)
+        avr_raise_irq(modbus->irq + 1, response[i]);
+
+    modbus->requests++;
+}
+
+static void uartHook(avr_irq_t* irq, const uint32_t value, void* param) {
+    (void) irq;
+    modbus_t* modbus = (modbus_t*) param;
+
+    modbus->frame[modbus->index++] = value;
+    if (modbus->index < MODBUS_FRAME_SIZE)
+        return;
+
+    const uint16_t crc = crc16(modbus->frame, MODBUS_FRAME_SIZE - 2);
+    if (modbus->frame[1] == MODBUS_READ_INPUT_REGISTERS
+        && modbus->frame[6] == (crc & 0xFF)
+        && modbus->frame[7] == (crc >> 8)) {
+        respond(modbus);
+        modbus->index = 0;
+        return;
+    }
+
+    // Resynchronise on the next byte
+    memmove(modbus->frame, modbus->frame + 1, MODBUS_FRAME_SIZE - 1);
+    modbus->index--;
+}
+
+void modbus_init(avr_t* avr, modbus_t* modbus, const char uart) {
+    static const char* names[] = {"modbus.rx", "modbus.tx"};
+
+    memset(modbus, 0, sizeof(modbus_t));
+    modbus->irq = avr_alloc_irq(&avr->irq_pool, 0, 2, names);
+
+    avr_irq_register_notify(modbus->irq, uartHook, modbus);
+    avr_connect_irq(avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ(uart), UART_IRQ_OUTPUT), modbus->irq);
+    avr_connect_irq(modbus->irq + 1, avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ(uart), UART_IRQ_INPUT));
+}
@@ -0,0 +1,41 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__MODBUS_MODEL__H
+#define STATION_MGMT__MODBUS_MODEL__H
+
+#include <stdint.h>
+
+#include <sim_avr.h>
+
+#define MODBUS_FRAME_SIZE 8
+#define MODBUS_MAX_REGISTERS 32
+
+typedef struct {
+    avr_irq_t* irq;
+    uint8_t frame[MODBUS_FRAME_SIZE];
+    uint8_t index;
+    uint32_t requests;
+} modbus_t;
+
+void modbus_init(avr_t* avr, modbus_t* modbus, char uart);
+
+#endif
@@ -0,0 +1,252 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "w5100_model.h"
+
+#include <string.h>
+
+#include <avr_ioport.h>
+#include <avr_spi.h>
+
+// Chip select of the Ethernet shield, digital pin 10 is PB4 on the Mega
+#define W5100_CS_PORT 'B'
+#define W5100_CS_PIN 4
+
+#define W5100_OPCODE_WRITE 0xF0
+#define W5100_OPCODE_READ 0x0F
+
+#define W5100_MR 0x0000
+#define W5100_MR_RESET 0x80
+
+#define W5100_SOCKET_BASE 0x0400
+#define W5100_SOCKET_SIZE 0x0100
+#define W5100_TX_BASE 0x4000
+#define W5100_RX_BASE 0x6000
+
+#define SN_MR 0x00
+#define SN_CR 0x01
+#define SN_IR 0x02
+#define SN_SR 0x03
+#define SN_PORT 0x04
+#define SN_TX_FSR 0x20
+#define SN_TX_RD 0x22
+#define SN_TX_WR 0x24
+#define SN_RX_RSR 0x26
+#define SN_RX_RD 0x28
+
+#define SN_CR_OPEN 0x01
+#define SN_CR_CLOSE 0x10
+#define SN_CR_SEND 0x20
+#define SN_CR_SEND_MAC 0x21
+#define SN_CR_RECV 0x40
+
+#define SN_IR_SEND_OK 0x10
+#define SN_IR_RECV 0x04
+
+#define SN_MR_UDP 0x02
+#define SN_SR_CLOSED 0x00
+#define SN_SR_UDP 0x22
+
+static uint16_t socketBase(const int socket) {
+    return W5100_SOCKET_BASE + socket * W5100_SOCKET_SIZE;
+}
+
+static uint16_t read16(const w5100_t* w5100, const uint16_t address) {
+    return (w5100->memory[address] << 8) | w5100->memory[address + 1];
+}
+
+static void write16(w5100_t* w5100, const uint16_t address, const uint16_t value) {
+    w5100->memory[address] = value >> 8;
+    w5100->memory[address + 1] = value & 0xFF;
+}
+
+static void executeCommand(w5100_t* w5100, const int socket, const uint8_t command) {
+    const uint16_t base = socketBase(socket);
+
+    switch (command) {
+        case SN_CR_OPEN:
+            w5100->memory[base + SN_SR] = (w5100->memory[base + SN_MR] & 0x0F) == SN_MR_UDP ? SN_SR_UDP : SN_SR_CLOSED;
+            write16(w5100, base + SN_TX_RD, 0);
+            write16(w5100, base + SN_TX_WR, 0);
+            write16(w5100, base + SN_RX_RD, 0);
+            w5100->rxWrite[socket] = 0;
+            break;
+
+        case SN_CR_CLOSE:
+            w5100->memory[base + SN_SR] = SN_SR_CLOSED;
+            break;
+
+        case SN_CR_SEND:
+        case SN_CR_SEND_MAC:
+            {
+                const uint16_t start = read16(w5100, base + SN_TX_RD);
+                const uint16_t end = read16(w5100, base + SN_TX_WR);
+                const uint16_t txBase = W5100_TX_BASE + socket * W5100_BUFFER_SIZE;
+
+                w5100->lastSendSize = (uint16_t) (end - start) % (W5100_BUFFER_SIZE + 1);
+                for (uint16_t i = 0; i < w5100->lastSendSize; i++)
+                    w5100->lastSend[i] = w5100->memory[txBase + ((start + i) & (W5100_BUFFER_SIZE - 1))];
+
+                write16(w5100, base + SN_TX_RD, end);
+                w5100->memory[base + SN_IR] |= SN_IR_SEND_OK;
+                w5100->sends++;
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+static uint8_t readRegister(const w5100_t* w5100, const uint16_t address) {
+    if (address >= W5100_SOCKET_BASE && address < W5100_SOCKET_BASE + W5100_SOCKETS * W5100_SOCKET_SIZE) {
+        const int socket = (address - W5100_SOCKET_BASE) / W5100_SOCKET_SIZE;
+        const uint16_t base = socketBase(socket);
+        const uint16_t offset = address - base;
+
+        switch (offset) {
+            case SN_CR:
+                return 0;
+
+            case SN_TX_FSR:
+            case SN_TX_FSR + 1:
+                {
+                    const uint16_t used = read16(w5100, base + SN_TX_WR) - read16(w5100, base + SN_TX_RD);
+                    const uint16_t free = W5100_BUFFER_SIZE - used;
+                    return offset == SN_TX_FSR ? free >> 8 : free & 0xFF;
+                }
+
+            case SN_RX_RSR:
+            case SN_RX_RSR + 1:
+                {
+                    const uint16_t received = w5100->rxWrite[socket] - read16(w5100, base + SN_RX_RD);
+                    return offset == SN_RX_RSR ? received >> 8 : received & 0xFF;
+                }
+
+            default:
+                break;
+        }
+    }
+
+    return w5100->memory[address & (W5100_MEMORY_SIZE - 1)];
+}
+
+static void writeRegister(w5100_t* w5100, const uint16_t address, const uint8_t value) {
+    if (address == W5100_MR && (value & W5100_MR_RESET)) {
+        memset(w5100->memory, 0, W5100_SOCKET_BASE + W5100_SOCKETS * W5100_SOCKET_SIZE);
+        return;
+    }
+
+    if (address >= W5100_SOCKET_BASE && address < W5100_SOCKET_BASE + W5100_SOCKETS * W5100_SOCKET_SIZE) {
+        const int socket = (address - W5100_SOCKET_BASE) / W5100_SOCKET_SIZE;
+        const uint16_t offset = address - socketBase(socket);
+
+        if (offset == SN_CR) {
+            executeCommand(w5100, socket, value);
+            return;
+        }
+
+        if (offset == SN_IR) {
+            w5100->memory[address] &= ~value;
+            return;
+        }
+    }
+
+    w5100->memory[address & (W5100_MEMORY_SIZE - 1)] = value;
+}
+
+static void spiHook(avr_irq_t* irq, const uint32_t value, void* param) {
+    (void) irq;
+    w5100_t* w5100 = (w5100_t*) param;
+
+    // The SD card shares the bus and is not modelled, it reads back as an idle line
+    uint8_t reply = 0xFF;
+
+    if (w5100->selected) {
+        w5100->frame[w5100->index] = value;
+        reply = w5100->index;
+
+        if (w5100->index == 3) {
+            const uint16_t address = (w5100->frame[1] << 8) | w5100->frame[2];
+            reply = 0;
+            if (w5100->frame[0] == W5100_OPCODE_WRITE)
+                writeRegister(w5100, address, value);
+            else if (w5100->frame[0] == W5100_OPCODE_READ)
+                reply = readRegister(w5100, address);
+        }
+
+        w5100->index = (w5100->index + 1) & 3;
+    }
+
+    avr_raise_irq(w5100->irq + SPI_IRQ_INPUT, reply);
+}
+
+static void chipSelectHook(avr_irq_t* irq, const uint32_t value, void* param) {
+    (void) irq;
+    w5100_t* w5100 = (w5100_t*) param;
+
+    w5100->selected = value == 0;
+    w5100->index = 0;
+}
+
+void w5100_init(avr_t* avr, w5100_t* w5100) {
+    static const char* names[] = {"w5100.mosi", "w5100.miso"};
+
+    memset(w5100, 0, sizeof(w5100_t));
+    w5100->irq = avr_alloc_irq(&avr->irq_pool, 0, 2, names);
+
+    avr_irq_register_notify(w5100->irq + SPI_IRQ_OUTPUT, spiHook, w5100);
+    avr_connect_irq(avr_io_getirq(avr, AVR_IOCTL_SPI_GETIRQ(0), SPI_IRQ_OUTPUT), w5100->irq + SPI_IRQ_OUTPUT);
+    avr_connect_irq(w5100->irq + SPI_IRQ_INPUT, avr_io_getirq(avr, AVR_IOCTL_SPI_GETIRQ(0), SPI_IRQ_INPUT));
+
+    avr_irq_register_notify(
+        avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(W5100_CS_PORT), W5100_CS_PIN), chipSelectHook, w5100);
+}
+
+int w5100_inject_udp(w5100_t* w5100, const uint16_t localPort, const uint8_t* payload, const uint16_t size) {
+    static const uint8_t remoteIp[] = {172, 29, 10, 1};
+    const uint16_t remotePort = 40000;
+
+    for (int socket = 0; socket < W5100_SOCKETS; socket++) {
+        const uint16_t base = socketBase(socket);
+        if (w5100->memory[base + SN_SR] != SN_SR_UDP || read16(w5100, base + SN_PORT) != localPort)
+            continue;
+
+        // Every datagram is preceded by the 8 byte W5100 UDP header: source IP, port and length
+        uint8_t packet[W5100_BUFFER_SIZE];
+        memcpy(packet, remoteIp, 4);
+        packet[4] = remotePort >> 8;
+        packet[5] = remotePort & 0xFF;
+        packet[6] = size >> 8;
+        packet[7] = size & 0xFF;
+        memcpy(packet + 8, payload, size);
+
+        const uint16_t rxBase = W5100_RX_BASE + socket * W5100_BUFFER_SIZE;
+        for (uint16_t i = 0; i < size + 8; i++)
+            w5100->memory[rxBase + ((w5100->rxWrite[socket] + i) & (W5100_BUFFER_SIZE - 1))] = packet[i];
+
+        w5100->rxWrite[socket] += size + 8;
+        w5100->memory[base + SN_IR] |= SN_IR_RECV;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,51 @@
+/*
+ * Station MGMT
+ *
+ * Copyright (C) 2023:
+ *  - Luca Cireddu IS0GVH (is0gvh@gmail.com)
+ *  - Stefano Lande IS0EIR (landeste@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STATION_MGMT__W5100_MODEL__H
+#define STATION_MGMT__W5100_MODEL__H
+
+#include <stdint.h>
+
+#include <sim_avr.h>
+
+#define W5100_MEMORY_SIZE 0x8000
+#define W5100_SOCKETS 4
+#define W5100_BUFFER_SIZE 0x0800
+
+typedef struct {
+    avr_irq_t* irq;
+    uint8_t memory[W5100_MEMORY_SIZE];
+    uint16_t rxWrite[W5100_SOCKETS];
+
+    int selected;
+    uint8_t frame[4];
+    uint8_t index;
+
+    uint32_t sends;
+    uint8_t lastSend[W5100_BUFFER_SIZE];
+    uint16_t lastSendSize;
+} w5100_t;
+
+void w5100_init(avr_t* avr, w5100_t* w5100);
+
+int w5100_inject_udp(w5100_t* w5100, uint16_t localPort, const uint8_t* payload, uint16_t size);
+
+#endif